@@ -0,0 +1,218 @@
+#ifndef RPQDB_CSRGraph_H
+#define RPQDB_CSRGraph_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+#include "rpqdb/Labels.hpp"
+
+namespace rpqdb {
+    using namespace std;
+
+    // Read-only view over a contiguous array owned elsewhere
+    template<typename T>
+    class ArrayView {
+    private:
+        const T* ptr = nullptr;
+        size_t len = 0;
+
+    public:
+        ArrayView() = default;
+        ArrayView(const T* data, size_t size) : ptr(data), len(size) {}
+        ArrayView(const vector<T>& v) : ptr(v.data()), len(v.size()) {}
+
+        const T& operator[](size_t i) const { return ptr[i]; }
+        const T* data() const { return ptr; }
+        const T* begin() const { return ptr; }
+        const T* end() const { return ptr + len; }
+        size_t size() const { return len; }
+        bool empty() const { return len == 0; }
+    };
+
+    // Frozen compressed sparse row (CSR) representation of a labelled graph.
+    // Vertices are renumbered to dense ids 0..n-1 (in increasing order of their
+    // original ids), and the out-edges of dense vertex v occupy the index range
+    // [offsets[v], offsets[v+1]) of the targets and labels arrays, sorted by
+    // (label, target) so that the edges of each label form a contiguous run.
+    //
+    // The arrays are views: they either point into vectors owned by this graph
+    // or into a memory-mapped snapshot (see GraphSnapshot.hpp). storage keeps
+    // whichever backing alive, so copies of a CSRGraph are shallow.
+    class CSRGraph {
+    public:
+        ArrayView<int> vertex_ids;     // dense id -> original id (sorted)
+        ArrayView<int> offsets;        // size numVertices() + 1
+        ArrayView<int> targets;        // dense target of each edge
+        ArrayView<LabelID> labels;     // interned label of each edge
+        shared_ptr<const void> storage;
+
+        int numVertices() const {
+            return vertex_ids.size();
+        }
+
+        int numEdges() const {
+            return targets.size();
+        }
+
+        int originalId(int dense) const {
+            return vertex_ids[dense];
+        }
+
+        // Returns -1 if the vertex is not part of the graph
+        int denseId(int original) const {
+            auto it = lower_bound(vertex_ids.begin(), vertex_ids.end(), original);
+            if (it == vertex_ids.end() || *it != original) {
+                return -1;
+            }
+            return it - vertex_ids.begin();
+        }
+
+        int outDegree(int dense) const {
+            return offsets[dense + 1] - offsets[dense];
+        }
+
+        // f(label, dense target)
+        template<typename F>
+        void forEachOutEdge(int dense, F&& f) const {
+            for (int i = offsets[dense]; i < offsets[dense + 1]; ++i) {
+                f(labels[i], targets[i]);
+            }
+        }
+
+        // f(label, begin, end) for each run of out-edges sharing a label;
+        // targets[begin..end) are the corresponding dense targets
+        template<typename F>
+        void forEachLabelRun(int dense, F&& f) const {
+            int i = offsets[dense];
+            int end = offsets[dense + 1];
+            while (i < end) {
+                int j = i + 1;
+                while (j < end && labels[j] == labels[i]) {
+                    ++j;
+                }
+                f(labels[i], i, j);
+                i = j;
+            }
+        }
+
+        // Index range [first, second) of the out-edges of dense with the given label
+        pair<int, int> labelRange(int dense, LabelID label) const {
+            auto range = equal_range(labels.begin() + offsets[dense], labels.begin() + offsets[dense + 1], label);
+            return {int(range.first - labels.begin()), int(range.second - labels.begin())};
+        }
+
+        // Sort the edges of every vertex by (label, target)
+        static void sortByLabel(const vector<int>& offsets, vector<int>& targets, vector<LabelID>& labels) {
+            vector<pair<LabelID, int>> edges;
+            for (size_t v = 0; v + 1 < offsets.size(); ++v) {
+                edges.clear();
+                for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                    edges.push_back({labels[i], targets[i]});
+                }
+                if (is_sorted(edges.begin(), edges.end())) {
+                    continue;
+                }
+                sort(edges.begin(), edges.end());
+                for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                    labels[i] = edges[i - offsets[v]].first;
+                    targets[i] = edges[i - offsets[v]].second;
+                }
+            }
+        }
+
+        // Transposed graph over the same dense ids (in-edges become out-edges)
+        CSRGraph reversed() const {
+            struct Arrays {
+                shared_ptr<const void> base; // vertex_ids are shared with this graph
+                vector<int> offsets;
+                vector<int> targets;
+                vector<LabelID> labels;
+            };
+            int n = numVertices();
+            auto arrays = make_shared<Arrays>();
+            arrays->base = storage;
+            arrays->offsets.assign(n + 1, 0);
+            for (int target : targets) {
+                arrays->offsets[target + 1] += 1;
+            }
+            for (int v = 0; v < n; ++v) {
+                arrays->offsets[v + 1] += arrays->offsets[v];
+            }
+            arrays->targets.resize(numEdges());
+            arrays->labels.resize(numEdges());
+            vector<int> next(arrays->offsets.begin(), arrays->offsets.end() - 1);
+            for (int v = 0; v < n; ++v) {
+                for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+                    int pos = next[targets[i]]++;
+                    arrays->targets[pos] = v;
+                    arrays->labels[pos] = labels[i];
+                }
+            }
+            sortByLabel(arrays->offsets, arrays->targets, arrays->labels);
+
+            CSRGraph csr;
+            csr.vertex_ids = vertex_ids;
+            csr.offsets = arrays->offsets;
+            csr.targets = arrays->targets;
+            csr.labels = arrays->labels;
+            csr.storage = arrays;
+            return csr;
+        }
+
+        // Take ownership of already laid out CSR arrays
+        static CSRGraph fromArrays(vector<int>&& vertex_ids, vector<int>&& offsets, vector<int>&& targets, vector<LabelID>&& labels) {
+            sortByLabel(offsets, targets, labels);
+            struct Arrays {
+                vector<int> vertex_ids;
+                vector<int> offsets;
+                vector<int> targets;
+                vector<LabelID> labels;
+            };
+            auto arrays = make_shared<Arrays>(Arrays{std::move(vertex_ids), std::move(offsets), std::move(targets), std::move(labels)});
+            CSRGraph csr;
+            csr.vertex_ids = arrays->vertex_ids;
+            csr.offsets = arrays->offsets;
+            csr.targets = arrays->targets;
+            csr.labels = arrays->labels;
+            csr.storage = arrays;
+            return csr;
+        }
+
+        // Freeze an adjacency list. EdgeList is any range of {label, dest} records.
+        template<typename EdgeList>
+        static CSRGraph build(const unordered_set<int>& vertices, const unordered_map<int, EdgeList>& adjList) {
+            vector<int> vertex_ids(vertices.begin(), vertices.end());
+            sort(vertex_ids.begin(), vertex_ids.end());
+            auto dense_id = [&](int v) -> int {
+                return lower_bound(vertex_ids.begin(), vertex_ids.end(), v) - vertex_ids.begin();
+            };
+
+            int n = vertex_ids.size();
+            vector<int> offsets(n + 1, 0);
+            for (const auto& [src, edges] : adjList) {
+                offsets[dense_id(src) + 1] += edges.size();
+            }
+            for (int v = 0; v < n; ++v) {
+                offsets[v + 1] += offsets[v];
+            }
+
+            vector<int> targets(offsets[n]);
+            vector<LabelID> labels(offsets[n]);
+            for (const auto& [src, edges] : adjList) {
+                int pos = offsets[dense_id(src)];
+                for (const auto& edge : edges) {
+                    targets[pos] = dense_id(edge.dest);
+                    labels[pos] = edge.label;
+                    ++pos;
+                }
+            }
+            return fromArrays(std::move(vertex_ids), std::move(offsets), std::move(targets), std::move(labels));
+        }
+    };
+} // namespace rpqdb
+
+#endif
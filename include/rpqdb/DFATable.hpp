@@ -0,0 +1,121 @@
+#ifndef RPQDB_DFATable_H
+#define RPQDB_DFATable_H
+
+#include <vector>
+#include <queue>
+#include <unordered_map>
+
+#include "rpqdb/NFA.hpp"
+#include "rpqdb/Labels.hpp"
+
+namespace rpqdb {
+	using namespace std;
+
+	// A DFA (as returned by NFA::getDFA()) compiled into a dense
+	// state x label -> next state table. States are renumbered 0..k-1 in BFS
+	// order from the start state, so the start state is always 0. Labels are
+	// the global LabelIDs known when the table was compiled; any later label
+	// has no transition.
+	class DFATable {
+	private:
+		int num_states = 0;
+		int num_labels = 0;
+		vector<int> next_state;           // state * num_labels + label -> state or -1
+		vector<int> previous_offsets;     // state * num_labels + label -> range in previous_states
+		vector<int> previous_states;      // states p with next(p, label) == state
+		vector<bool> accepting;
+		vector<bool> has_incoming;
+
+	public:
+		static constexpr int NONE = -1;
+
+		explicit DFATable(NFA& dfa) {
+			unordered_map<State*, int> index;
+			vector<State*> states;
+			queue<State*> worklist;
+			index[dfa.start_state] = 0;
+			states.push_back(dfa.start_state);
+			worklist.push(dfa.start_state);
+			while (!worklist.empty()) {
+				State* s = worklist.front();
+				worklist.pop();
+				for (const auto& trans : s->transitions) {
+					if (index.emplace(trans.target, states.size()).second) {
+						states.push_back(trans.target);
+						worklist.push(trans.target);
+					}
+				}
+			}
+
+			num_states = states.size();
+			num_labels = LabelDictionary::global().size();
+			next_state.assign(num_states * num_labels, NONE);
+			previous_offsets.assign(num_states * num_labels + 1, 0);
+			has_incoming.assign(num_states, false);
+			for (State* s : states) {
+				accepting.push_back(s->is_accepting);
+				for (const auto& trans : s->transitions) {
+					int to = index[trans.target];
+					next_state[index[s] * num_labels + trans.label] = to;
+					previous_offsets[to * num_labels + trans.label + 1] += 1;
+					has_incoming[to] = true;
+				}
+			}
+			for (size_t i = 1; i < previous_offsets.size(); ++i) {
+				previous_offsets[i] += previous_offsets[i - 1];
+			}
+			previous_states.resize(previous_offsets.back());
+			vector<int> fill(previous_offsets.begin(), previous_offsets.end() - 1);
+			for (int p = 0; p < num_states; ++p) {
+				for (int label = 0; label < num_labels; ++label) {
+					int q = next_state[p * num_labels + label];
+					if (q != NONE) {
+						previous_states[fill[q * num_labels + label]++] = p;
+					}
+				}
+			}
+		}
+
+		int numStates() const {
+			return num_states;
+		}
+
+		int numLabels() const {
+			return num_labels;
+		}
+
+		int startState() const {
+			return 0;
+		}
+
+		bool isAccepting(int state) const {
+			return accepting[state];
+		}
+
+		bool hasIncomingTransitions(int state) const {
+			return has_incoming[state];
+		}
+
+		// NONE if there is no transition
+		int next(int state, LabelID label) const {
+			if (label >= num_labels) {
+				return NONE;
+			}
+			return next_state[state * num_labels + label];
+		}
+
+		// f(p) for every state p with next(p, label) == state
+		template<typename F>
+		void forEachPrevious(int state, LabelID label, F&& f) const {
+			if (label >= num_labels) {
+				return;
+			}
+			int slot = state * num_labels + label;
+			for (int i = previous_offsets[slot]; i < previous_offsets[slot + 1]; ++i) {
+				f(previous_states[i]);
+			}
+		}
+	};
+} // namespace rpqdb
+
+#endif
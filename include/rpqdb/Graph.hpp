@@ -5,6 +5,7 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <array>
 #include <map>
 #include <unordered_map>
 #include <unordered_set>
@@ -14,35 +15,58 @@
 #include <functional>
 #include <stack>
 #include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
 
 #include "NFA.hpp"
+#include "rpqdb/CSRGraph.hpp"
+#include "rpqdb/DFATable.hpp"
+#include "rpqdb/GraphSnapshot.hpp"
+#include "rpqdb/ParallelLoader.hpp"
 #include "rpqdb/Profiler.hpp"
+#include "rpqdb/RoaringSet.hpp"
+#include "rpqdb/SCC.hpp"
+#include "rpqdb/ThreadPool.hpp"
+#include "rpqdb/VisitedSet.hpp"
 #include <boost/container/flat_set.hpp>
 
-// Custom hash for StatePair
-using StatePair = std::pair<rpqdb::State*, int>;
-
-namespace std {
-    template<>
-    struct hash<StatePair> {
-        size_t operator()(const StatePair& sp) const {
-            // Combine hash of the pointer and the integer
-            size_t h1 = hash<rpqdb::State*>()(sp.first);   // Hash the pointer
-            size_t h2 = hash<int>()(sp.second);     // Hash the int
-            return h1 ^ (h2 << 1);  // Combine hashes (avoid XOR symmetry)
-        }
-    };
-}
-
 namespace rpqdb{
     using namespace std;
 
     // Represents a labeled edge in the graph
     struct Edge {
-        string label;
+        LabelID label;
         int dest;
     };
     
+    // Streaming evaluators hand each (source, destination) pair to a sink as
+    // soon as it is final instead of storing it. A sink returns void, or bool
+    // where false asks the evaluator to stop. Returns false if it should stop.
+    template<typename Sink>
+    inline bool emitPair(Sink& emit, int source, int destination) {
+        if constexpr (is_same_v<decltype(emit(source, destination)), bool>) {
+            return emit(source, destination);
+        } else {
+            emit(source, destination);
+            return true;
+        }
+    }
+
+    // LIMIT on the answer of a query: at most total pairs overall and at most
+    // per_source pairs for any one source. Which pairs are kept is up to the
+    // evaluator, but each is a true answer, and a source with fewer answers
+    // than per_source keeps all of them unless total is hit first.
+    struct QueryLimit {
+        size_t total = numeric_limits<size_t>::max();
+        size_t per_source = numeric_limits<size_t>::max();
+
+        bool unlimited() const {
+            return total == numeric_limits<size_t>::max() && per_source == numeric_limits<size_t>::max();
+        }
+    };
+
     // Allow fine tuning the data structure for the result
     template<typename SetType>
     class ReachablePairs {
@@ -58,6 +82,30 @@ namespace rpqdb{
                 reachability_map[x].insert(y);
             }
 
+            bool contains(int x, int y) const {
+                auto it = reachability_map.find(x);
+                return it != reachability_map.end() && it->second.count(y) > 0;
+            }
+
+            // f(source, destination) for every pair
+            template<typename F>
+            void forEachPair(F&& f) const {
+                for (const auto& [source, destinations] : reachability_map) {
+                    for (const auto& dest : destinations) {
+                        f(source, dest);
+                    }
+                }
+            }
+
+            // Total number of (source, destination) pairs
+            size_t size() const {
+                size_t total = 0;
+                for (const auto& [source, destinations] : reachability_map) {
+                    total += destinations.size();
+                }
+                return total;
+            }
+
             void print() const {
                 std::cout << "Reachable pairs:\n";
                 for (const auto& [source, destinations] : reachability_map) {
@@ -72,19 +120,31 @@ namespace rpqdb{
 
     using UnorderedReachablePairs = ReachablePairs<std::unordered_set<int>>;
     using VectorReachablePairs = ReachablePairs<boost::container::flat_set<int>>;
+    using RoaringReachablePairs = ReachablePairs<RoaringSet>;
 
     // Graph class stores adjacency list representation
     class Graph {   
     private:
         int totalEdges = 0;
+        // Set once the graph is sealed; shared so that copies stay cheap
+        shared_ptr<const CSRGraph> csr;
+        // Transposed CSR, built on first use
+        mutable shared_ptr<const CSRGraph> reverse_csr;
         
-        void addEdge(int v1, const string& label, int v2) {
+        void addEdge(int v1, LabelID label, int v2) {
+            if (csr) {
+                throw runtime_error("Cannot add edges to a sealed graph");
+            }
             adjList[v1].push_back({label, v2});
             vertices.insert(v1);
             vertices.insert(v2);
             totalEdges += 1;
         }
 
+        void addEdge(int v1, const string& label, int v2) {
+            addEdge(v1, internLabel(label), v2);
+        }
+
     public:
         unordered_map<int, vector<Edge>> adjList;
         unordered_set<int> vertices;
@@ -95,6 +155,112 @@ namespace rpqdb{
         int getEdges() {
             return totalEdges;
         }
+
+        // Freeze the graph into CSR form and release the adjacency list.
+        // adjList and vertices are empty afterwards; use the forEach* accessors.
+        void seal() {
+            if (csr) {
+                return;
+            }
+            csr = make_shared<const CSRGraph>(CSRGraph::build(vertices, adjList));
+            unordered_map<int, vector<Edge>>().swap(adjList);
+            unordered_set<int>().swap(vertices);
+        }
+
+        bool isSealed() const {
+            return csr != nullptr;
+        }
+
+        const CSRGraph& getCSR() const {
+            if (!csr) {
+                throw runtime_error("Graph is not sealed");
+            }
+            return *csr;
+        }
+
+        // In-edges of the sealed graph as a CSR over the same dense ids
+        const CSRGraph& getReverseCSR() const {
+            if (!reverse_csr) {
+                reverse_csr = make_shared<const CSRGraph>(getCSR().reversed());
+            }
+            return *reverse_csr;
+        }
+
+        // The sealed CSR, or a temporary CSR of the adjacency list when not sealed
+        shared_ptr<const CSRGraph> denseView() const {
+            if (csr) {
+                return csr;
+            }
+            return make_shared<const CSRGraph>(CSRGraph::build(vertices, adjList));
+        }
+
+        // Transposed counterpart of denseView(); cached when sealed
+        shared_ptr<const CSRGraph> reverseDenseView() const {
+            if (csr) {
+                getReverseCSR();
+                return reverse_csr;
+            }
+            return make_shared<const CSRGraph>(denseView()->reversed());
+        }
+
+        int getVertexCount() const {
+            return csr ? csr->numVertices() : vertices.size();
+        }
+
+        // f(vertex)
+        template<typename F>
+        void forEachVertex(F&& f) const {
+            if (csr) {
+                for (int v : csr->vertex_ids) {
+                    f(v);
+                }
+            } else {
+                for (int v : vertices) {
+                    f(v);
+                }
+            }
+        }
+
+        // f(src, label, dest)
+        template<typename F>
+        void forEachEdge(F&& f) const {
+            if (csr) {
+                for (int v = 0; v < csr->numVertices(); ++v) {
+                    int src = csr->originalId(v);
+                    csr->forEachOutEdge(v, [&](LabelID label, int dest) {
+                        f(src, label, csr->originalId(dest));
+                    });
+                }
+            } else {
+                for (const auto& [src, edges] : adjList) {
+                    for (const Edge& e : edges) {
+                        f(src, e.label, e.dest);
+                    }
+                }
+            }
+        }
+
+        // f(label, dest) for every out-edge of vertex v
+        template<typename F>
+        void forEachOutEdge(int v, F&& f) const {
+            if (csr) {
+                int dense = csr->denseId(v);
+                if (dense < 0) {
+                    return;
+                }
+                csr->forEachOutEdge(dense, [&](LabelID label, int dest) {
+                    f(label, csr->originalId(dest));
+                });
+            } else {
+                auto it = adjList.find(v);
+                if (it == adjList.end()) {
+                    return;
+                }
+                for (const Edge& e : it->second) {
+                    f(e.label, e.dest);
+                }
+            }
+        }
     
         // A debug method for visualizing the content of the graph
         void print(){
@@ -110,13 +276,13 @@ namespace rpqdb{
             }
             cout << endl;
         
-            for (const auto& [src, edges] : adjList) {
+            forEachVertex([&](int src) {
                 cout << src << ": ";
-                for (const auto& edge : edges) {
-                    cout << "(" << edge.label << " -> " << edge.dest << ") ";
-                }
+                forEachOutEdge(src, [&](LabelID label, int dest) {
+                    cout << "(" << labelName(label) << " -> " << dest << ") ";
+                });
                 cout << endl;
-            }
+            });
         }
 
         // Serialization format: v1 label v2
@@ -167,62 +333,191 @@ namespace rpqdb{
             }
         }
 
+        // Serialization format: v1 label v2
+        // Multi-threaded loader for large edge lists. The file is split into byte
+        // ranges that are parsed concurrently (see ParallelLoader.hpp), and the
+        // per-thread edge buffers are merged straight into a sealed CSR graph.
+        // With labelled = true, a/c self-loops are handled as in
+        // buildLabelledGraphFromFile().
+        void buildFromFileParallel(const string& filename, const string& separator, bool labelled = false, int threads = 0) {
+            if (csr || !adjList.empty()) {
+                throw runtime_error("buildFromFileParallel requires an empty graph");
+            }
+            unique_ptr<MappedFile> file;
+            try {
+                file = make_unique<MappedFile>(filename);
+            } catch (const runtime_error& e) {
+                cerr << "Error: Unable to open file " << filename << " in the current directory." << endl;
+                return;
+            }
+            vector<EdgeChunk> chunks = parseEdgeChunks(*file, separator, labelled, threads);
+
+            auto for_each_chunk = [&](auto&& f) {
+                vector<thread> workers;
+                for (size_t i = 0; i < chunks.size(); ++i) {
+                    workers.emplace_back([&, i]() { f(chunks[i], i); });
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+            };
+
+            // Local label numbers -> global ids (labels are few, done serially)
+            vector<vector<LabelID>> label_maps(chunks.size());
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                for (const auto& name : chunks[i].label_names) {
+                    label_maps[i].push_back(internLabel(string(name)));
+                }
+            }
+
+            // Sorted distinct endpoints per chunk, then merged
+            vector<vector<int>> chunk_vertices(chunks.size());
+            for_each_chunk([&](EdgeChunk& chunk, size_t i) {
+                vector<int>& ids = chunk_vertices[i];
+                ids.reserve(chunk.sources.size() * 2);
+                ids.insert(ids.end(), chunk.sources.begin(), chunk.sources.end());
+                ids.insert(ids.end(), chunk.dests.begin(), chunk.dests.end());
+                sort(ids.begin(), ids.end());
+                ids.erase(unique(ids.begin(), ids.end()), ids.end());
+            });
+            vector<int> vertex_ids;
+            for (auto& ids : chunk_vertices) {
+                vector<int> merged;
+                merged.reserve(vertex_ids.size() + ids.size());
+                set_union(vertex_ids.begin(), vertex_ids.end(), ids.begin(), ids.end(), back_inserter(merged));
+                vertex_ids.swap(merged);
+                vector<int>().swap(ids);
+            }
+
+            // Rewrite endpoints and labels in place as dense ids / global labels
+            for_each_chunk([&](EdgeChunk& chunk, size_t i) {
+                auto dense_id = [&](int v) -> int {
+                    return lower_bound(vertex_ids.begin(), vertex_ids.end(), v) - vertex_ids.begin();
+                };
+                for (size_t e = 0; e < chunk.sources.size(); ++e) {
+                    chunk.sources[e] = dense_id(chunk.sources[e]);
+                    chunk.dests[e] = dense_id(chunk.dests[e]);
+                    chunk.local_labels[e] = label_maps[i][chunk.local_labels[e]];
+                }
+            });
+
+            // Counting sort by source; CSRGraph::fromArrays() then orders the
+            // edges of each vertex by (label, target)
+            int n = vertex_ids.size();
+            vector<int> offsets(n + 1, 0);
+            for (const auto& chunk : chunks) {
+                for (int src : chunk.sources) {
+                    offsets[src + 1] += 1;
+                }
+            }
+            for (int v = 0; v < n; ++v) {
+                offsets[v + 1] += offsets[v];
+            }
+            vector<int> targets(offsets[n]);
+            vector<LabelID> labels(offsets[n]);
+            vector<int> next(offsets.begin(), offsets.end() - 1);
+            for (const auto& chunk : chunks) {
+                for (size_t e = 0; e < chunk.sources.size(); ++e) {
+                    int pos = next[chunk.sources[e]]++;
+                    targets[pos] = chunk.dests[e];
+                    labels[pos] = chunk.local_labels[e];
+                }
+                starting_vertices.insert(chunk.starting.begin(), chunk.starting.end());
+                accepting_vertices.insert(chunk.accepting.begin(), chunk.accepting.end());
+            }
+
+            totalEdges = offsets[n];
+            csr = make_shared<const CSRGraph>(CSRGraph::fromArrays(std::move(vertex_ids), std::move(offsets), std::move(targets), std::move(labels)));
+        }
+
+        // Write a binary snapshot (see GraphSnapshot.hpp); seals the graph first
+        void saveSnapshot(const string& filename) {
+            seal();
+            GraphSnapshot::write(filename, *csr, starting_vertices, accepting_vertices);
+        }
+
+        // Load a snapshot written by saveSnapshot() into an empty graph.
+        // The graph is sealed and its CSR arrays are served from the mapped file.
+        void loadSnapshot(const string& filename) {
+            if (csr || !adjList.empty()) {
+                throw runtime_error("loadSnapshot requires an empty graph");
+            }
+            GraphSnapshot snapshot = GraphSnapshot::load(filename);
+            csr = make_shared<const CSRGraph>(std::move(snapshot.csr));
+            totalEdges = csr->numEdges();
+            starting_vertices = std::move(snapshot.starting_vertices);
+            accepting_vertices = std::move(snapshot.accepting_vertices);
+        }
+
         // Construct a product graph from a DFA
+        // The DFA is compiled into a state x label table, so each out-edge (or,
+        // when sealed, each run of same-label out-edges) costs one table lookup
         Graph product(NFA& dfa) {
             Graph result;
+            DFATable table(dfa);
             int product_vertex_id = 0;
-			unordered_map<StatePair, int> state_map;
-            State * start1 = dfa.start_state;
-            
-            // Helper function to get or create a new state in the product NFA
-			auto get_or_create_vertex = [&](State* s1, int s2) -> int {
-				StatePair key = {s1, s2};
-				if (state_map.find(key) == state_map.end()) {
-					product_vertex_id += 1;
-					state_map[key] = product_vertex_id;
-				}
-				return state_map[key];
-			};
+            // (DFA state, vertex) -> product vertex; vertices are dense ids when sealed
+            unordered_map<int64_t, int> state_map;
 
             // Perform a breadth-first search (BFS) to explore all reachable state pairs
-			queue<StatePair> queue;
-            unordered_set<StatePair> visited;
-
-            for (const auto& x : vertices) {
-                queue.push({start1, x});
-                // Get the corresponding state in the product NFA
-				int product_state = get_or_create_vertex(start1, x);
-                result.starting_vertices.insert(product_state);
-            }
-
-			while (!queue.empty()) {
-				auto [current1, current2] = queue.front();
-				queue.pop();
-                visited.insert({current1, current2});
-
-				// Get the corresponding state in the product NFA
-				int current_product_state = get_or_create_vertex(current1, current2);
-                if (current1->is_accepting) {
-                    result.accepting_vertices.insert(current_product_state);
-                }
-
-				// Process transitions
-				for (const auto& trans1 : current1->transitions) {
-					for (const auto& trans2 : adjList[current2]) {
-						State* next1 = trans1.target;
-						if (trans1.label == trans2.label) {
-							int next_product_state = get_or_create_vertex(next1, trans2.dest);
-							result.addEdge(current_product_state, trans1.label, next_product_state);
-							// check if the node has been visited
-                            if (visited.find({next1, trans2.dest}) == visited.end()){
-                                queue.push({next1, trans2.dest});
-                            }
-						}
-					}
-				}
-			}
+            // Each entry is (DFA state, vertex, product vertex)
+            queue<tuple<int, int, int>> queue;
+
+            // Helper function to get or create a new state in the product NFA
+            // New state pairs are queued once, when they are created
+            auto get_or_create_vertex = [&](int state, int vertex) -> int {
+                int64_t key = (int64_t(state) << 32) | uint32_t(vertex);
+                auto [it, inserted] = state_map.try_emplace(key, product_vertex_id + 1);
+                if (inserted) {
+                    product_vertex_id += 1;
+                    queue.push({state, vertex, it->second});
+                    if (table.isAccepting(state)) {
+                        result.accepting_vertices.insert(it->second);
+                    }
+                }
+                return it->second;
+            };
 
-			return result;
+            if (csr) {
+                for (int x = 0; x < csr->numVertices(); ++x) {
+                    result.starting_vertices.insert(get_or_create_vertex(table.startState(), x));
+                }
+            } else {
+                for (int x : vertices) {
+                    result.starting_vertices.insert(get_or_create_vertex(table.startState(), x));
+                }
+            }
+
+            while (!queue.empty()) {
+                auto [state, vertex, current_product_state] = queue.front();
+                queue.pop();
+
+                if (csr) {
+                    // Skip whole label runs the DFA cannot follow
+                    csr->forEachLabelRun(vertex, [&](LabelID label, int begin, int end) {
+                        int next = table.next(state, label);
+                        if (next == DFATable::NONE) {
+                            return;
+                        }
+                        for (int i = begin; i < end; ++i) {
+                            result.addEdge(current_product_state, label, get_or_create_vertex(next, csr->targets[i]));
+                        }
+                    });
+                } else {
+                    auto it = adjList.find(vertex);
+                    if (it == adjList.end()) {
+                        continue;
+                    }
+                    for (const Edge& e : it->second) {
+                        int next = table.next(state, e.label);
+                        if (next != DFATable::NONE) {
+                            result.addEdge(current_product_state, e.label, get_or_create_vertex(next, e.dest));
+                        }
+                    }
+                }
+            }
+
+            return result;
         }
 
         UnorderedReachablePairs PG() {
@@ -231,43 +526,47 @@ namespace rpqdb{
             unordered_map<int, unordered_set<int>> result;
 
             if (starting_vertices.empty() || accepting_vertices.empty()) {
+                END_LOCAL();
                 return ReachablePairs<std::unordered_set<int>>();
             }
-            if (adjList.empty()){
+            if (csr ? csr->numEdges() == 0 : adjList.empty()){
+                END_LOCAL();
                 return ReachablePairs<std::unordered_set<int>>();
             }
 
-            VERSIONED_IMPLEMENTATION("Using bit vector for visited is much faster than set, but not fair comparison with semi-naive and ospg", {
-                std::vector<bool> visited(adjList.size(), false);
-                if (visited[start]){
-                    ...
+            // Traverse dense ids so that visited marks are an epoch array, reset in O(1) per source
+            shared_ptr<const CSRGraph> graph = denseView();
+            vector<bool> is_accepting(graph->numVertices(), false);
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    is_accepting[dense] = true;
                 }
-                visited[start] = true;
-                if (neighbor < visited.size() && !visited[neighbor]) {
-                    visited[neighbor] = true;
-                    q.push(neighbor);
-            }});
+            }
+            EpochVisitedSet visited(graph->numVertices());
+            vector<int> q;
 
             // For each starting vertex, perform BFS to find reachable accepting vertices
             for (const auto& start : starting_vertices) {
-                unordered_set<int> visited;
-                std::queue<int> q;
                 std::unordered_set<int> accept_nodes;
-                q.push(start);
+                int dense_start = graph->denseId(start);
+                visited.clear();
+                q.clear();
+                if (dense_start >= 0) {
+                    q.push_back(dense_start);
+                    visited.insert(dense_start);
+                }
 
-                while (!q.empty()) {
-                    int current = q.front();
-                    q.pop();
-                    visited.insert(current);
+                for (size_t head = 0; head < q.size(); ++head) {
+                    int current = q[head];
 
                     // Explore all neighbors
-                    for (const auto& edge : adjList[current]) {
-                        int neighbor = edge.dest;
-
-                        if (visited.find(neighbor) == visited.end()) { // not visited
-                            q.push(neighbor);
-                            if (accept_nodes.find(neighbor) == accept_nodes.end() && accepting_vertices.find(neighbor) != accepting_vertices.end()) {
-                                accept_nodes.insert(neighbor);
+                    for (int i = graph->offsets[current]; i < graph->offsets[current + 1]; ++i) {
+                        int neighbor = graph->targets[i];
+                        if (visited.insert(neighbor)) { // not visited
+                            q.push_back(neighbor);
+                            if (is_accepting[neighbor]) {
+                                accept_nodes.insert(graph->originalId(neighbor));
                             }
                         }
                     }
@@ -282,23 +581,531 @@ namespace rpqdb{
             return UnorderedReachablePairs(result);
         }
 
+        // PG() evaluated from the accepting side: one BFS per accepting vertex
+        // over the transposed adjacency, reporting the starting vertices it
+        // reaches. Cheaper than PG() when accepting vertices, or the backward
+        // traversals from them, are fewer than on the starting side. Same
+        // answers as PG(), except that starts without any pair have no entry.
+        UnorderedReachablePairs PG_Backward() {
+            unordered_map<int, unordered_set<int>> result;
+            if (starting_vertices.empty() || accepting_vertices.empty()) {
+                return UnorderedReachablePairs(result);
+            }
+            START_LOCAL("BFS backward");
+            shared_ptr<const CSRGraph> reverse = reverseDenseView();
+            vector<bool> is_starting(reverse->numVertices(), false);
+            for (int v : starting_vertices) {
+                int dense = reverse->denseId(v);
+                if (dense >= 0) {
+                    is_starting[dense] = true;
+                }
+            }
+            EpochVisitedSet visited(reverse->numVertices());
+            vector<int> q;
+            for (int accept : accepting_vertices) {
+                int dense_accept = reverse->denseId(accept);
+                if (dense_accept < 0) {
+                    continue;
+                }
+                visited.clear();
+                visited.insert(dense_accept);
+                q.assign(1, dense_accept);
+                for (size_t head = 0; head < q.size(); ++head) {
+                    int current = q[head];
+                    for (int i = reverse->offsets[current]; i < reverse->offsets[current + 1]; ++i) {
+                        int neighbor = reverse->targets[i];
+                        if (visited.insert(neighbor)) {
+                            q.push_back(neighbor);
+                            if (is_starting[neighbor]) {
+                                result[reverse->originalId(neighbor)].insert(accept);
+                            }
+                        }
+                    }
+                }
+            }
+            END_LOCAL();
+            return UnorderedReachablePairs(result);
+        }
+
+        // PG() streamed to emit(start, target) (see emitPair()): each pair is
+        // emitted as soon as the BFS from start discovers target, so memory is
+        // one visited set and queue whatever the size of the answer. Sources
+        // without any pair emit nothing. The BFS from a source stops once it
+        // has emitted limit.per_source pairs, and the whole stream once it has
+        // emitted limit.total.
+        template<typename Sink>
+        void PG_Stream(Sink&& emit, const QueryLimit& limit = {}) {
+            if (starting_vertices.empty() || accepting_vertices.empty() || limit.total == 0 || limit.per_source == 0) {
+                return;
+            }
+            START_LOCAL("BFS stream");
+            shared_ptr<const CSRGraph> graph = denseView();
+            vector<bool> is_accepting(graph->numVertices(), false);
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    is_accepting[dense] = true;
+                }
+            }
+            EpochVisitedSet visited(graph->numVertices());
+            vector<int> q;
+            size_t total = 0;
+            bool more = true;
+            for (auto it = starting_vertices.begin(); more && it != starting_vertices.end(); ++it) {
+                int start = *it;
+                int dense_start = graph->denseId(start);
+                if (dense_start < 0) {
+                    continue;
+                }
+                size_t found = 0;
+                visited.clear();
+                visited.insert(dense_start);
+                q.assign(1, dense_start);
+                for (size_t head = 0; more && found < limit.per_source && head < q.size(); ++head) {
+                    int current = q[head];
+                    for (int i = graph->offsets[current]; more && found < limit.per_source && i < graph->offsets[current + 1]; ++i) {
+                        int neighbor = graph->targets[i];
+                        if (visited.insert(neighbor)) {
+                            q.push_back(neighbor);
+                            if (is_accepting[neighbor]) {
+                                found++;
+                                more = emitPair(emit, start, graph->originalId(neighbor)) && ++total < limit.total;
+                            }
+                        }
+                    }
+                }
+            }
+            END_LOCAL();
+        }
+
+        // PG() under a LIMIT: only as much of each BFS as the limit needs
+        UnorderedReachablePairs PG(const QueryLimit& limit) {
+            UnorderedReachablePairs result;
+            PG_Stream([&](int x, int y) {
+                result.addPair(x, y);
+            }, limit);
+            return result;
+        }
+
+        // Multi-source BFS behind PG_BitParallel() and PG_Count(): dense sources
+        // are processed in batches of 64 * Words, and every vertex carries one
+        // "seen" and one "frontier" bit per source of the batch, so a single
+        // edge scan advances the BFS of all sources at once. After each batch,
+        // on_batch(batch, seen, seed) gets the Words words per vertex in which
+        // bit i is set when sources[batch + i] reaches the vertex (seen) or is
+        // the vertex (seed). Sources must be distinct.
+        template<int Words, typename F>
+        static void bitParallelBFS(const CSRGraph& graph, const vector<int>& sources, F&& on_batch) {
+            int n = graph.numVertices();
+            const int batch_size = 64 * Words;
+
+            // Words consecutive uint64_t per vertex
+            vector<uint64_t> seen(size_t(n) * Words, 0);
+            vector<uint64_t> seed(size_t(n) * Words, 0);
+            vector<uint64_t> frontier(size_t(n) * Words, 0);
+            vector<uint64_t> next(size_t(n) * Words, 0);
+            vector<int> active, touched;
+
+            for (size_t batch = 0; batch < sources.size(); batch += batch_size) {
+                size_t batch_end = min(sources.size(), batch + batch_size);
+                active.clear();
+                for (size_t i = batch; i < batch_end; ++i) {
+                    int v = sources[i];
+                    size_t slot = size_t(v) * Words + (i - batch) / 64;
+                    uint64_t bit = uint64_t(1) << ((i - batch) % 64);
+                    seed[slot] = seen[slot] = frontier[slot] = bit;
+                    active.push_back(v);
+                }
+
+                while (!active.empty()) {
+                    touched.clear();
+                    for (int v : active) {
+                        const uint64_t* from = &frontier[size_t(v) * Words];
+                        for (int i = graph.offsets[v]; i < graph.offsets[v + 1]; ++i) {
+                            uint64_t* to = &next[size_t(graph.targets[i]) * Words];
+                            bool untouched = true;
+                            for (int w = 0; w < Words; ++w) {
+                                untouched &= to[w] == 0;
+                                to[w] |= from[w];
+                            }
+                            if (untouched) {
+                                touched.push_back(graph.targets[i]);
+                            }
+                        }
+                    }
+                    for (int v : active) {
+                        fill_n(&frontier[size_t(v) * Words], Words, 0);
+                    }
+                    active.clear();
+                    // Keep only the sources that reach the vertex for the first time
+                    for (int v : touched) {
+                        uint64_t* fresh = &next[size_t(v) * Words];
+                        uint64_t* visited = &seen[size_t(v) * Words];
+                        bool any = false;
+                        for (int w = 0; w < Words; ++w) {
+                            fresh[w] &= ~visited[w];
+                            visited[w] |= fresh[w];
+                            any |= fresh[w] != 0;
+                        }
+                        if (any) {
+                            copy_n(fresh, Words, &frontier[size_t(v) * Words]);
+                            active.push_back(v);
+                        }
+                        fill_n(fresh, Words, 0);
+                    }
+                }
+
+                on_batch(batch, static_cast<const vector<uint64_t>&>(seen), static_cast<const vector<uint64_t>&>(seed));
+                fill(seen.begin(), seen.end(), 0);
+                fill(seed.begin(), seed.end(), 0);
+            }
+        }
+
+        // Dense ids of the starting vertices that are in the graph
+        vector<int> denseStartingVertices(const CSRGraph& graph) const {
+            vector<int> sources;
+            for (int start : starting_vertices) {
+                int dense = graph.denseId(start);
+                if (dense >= 0) {
+                    sources.push_back(dense);
+                }
+            }
+            return sources;
+        }
+
+        // Multi-source variant of PG() on bitParallelBFS(). Same answers as PG().
+        template<int Words = 4>
+        UnorderedReachablePairs PG_BitParallel() {
+            unordered_map<int, unordered_set<int>> result;
+            if (starting_vertices.empty() || accepting_vertices.empty()) {
+                return UnorderedReachablePairs();
+            }
+            START_LOCAL("BFS bit-parallel");
+            shared_ptr<const CSRGraph> graph = denseView();
+
+            vector<int> accepting;
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    accepting.push_back(dense);
+                }
+            }
+            for (int start : starting_vertices) {
+                result[start];
+            }
+            vector<int> sources = denseStartingVertices(*graph);
+
+            bitParallelBFS<Words>(*graph, sources, [&](size_t batch, const vector<uint64_t>& seen, const vector<uint64_t>& seed) {
+                // As in PG(), a source is not reported as reaching itself
+                for (int v : accepting) {
+                    for (int w = 0; w < Words; ++w) {
+                        uint64_t bits = seen[size_t(v) * Words + w] & ~seed[size_t(v) * Words + w];
+                        while (bits) {
+                            int i = batch + w * 64 + __builtin_ctzll(bits);
+                            result[graph->originalId(sources[i])].insert(graph->originalId(v));
+                            bits &= bits - 1;
+                        }
+                    }
+                }
+            });
+            END_LOCAL();
+            return UnorderedReachablePairs(result);
+        }
+
+        // PG().size() without storing any pair: bitParallelBFS() and, per
+        // accepting vertex, a popcount of the sources reaching it
+        template<int Words = 4>
+        size_t PG_Count() {
+            if (starting_vertices.empty() || accepting_vertices.empty()) {
+                return 0;
+            }
+            START_LOCAL("BFS count");
+            shared_ptr<const CSRGraph> graph = denseView();
+            vector<int> accepting;
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    accepting.push_back(dense);
+                }
+            }
+            size_t count = 0;
+            bitParallelBFS<Words>(*graph, denseStartingVertices(*graph), [&](size_t, const vector<uint64_t>& seen, const vector<uint64_t>& seed) {
+                for (int v : accepting) {
+                    for (int w = 0; w < Words; ++w) {
+                        count += __builtin_popcountll(seen[size_t(v) * Words + w] & ~seed[size_t(v) * Words + w]);
+                    }
+                }
+            });
+            END_LOCAL();
+            return count;
+        }
+
+        // PG() has a pair, i.e. some accepting vertex is reached from a
+        // starting vertex other than itself by one or more edges. A single
+        // traversal from all starting vertices at once: each vertex records up
+        // to two distinct sources reaching it, which is enough to tell whether
+        // an accepting start is reached from another start, and is expanded
+        // once per recorded source. Stops at the first such vertex.
+        bool PG_Exists() {
+            if (starting_vertices.empty() || accepting_vertices.empty()) {
+                return false;
+            }
+            START_LOCAL("BFS exists");
+            shared_ptr<const CSRGraph> graph = denseView();
+            int n = graph->numVertices();
+            vector<bool> is_accepting(n, false);
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    is_accepting[dense] = true;
+                }
+            }
+
+            // sources reaching each vertex by one or more edges, -1 if none
+            vector<array<int, 2>> origins(n, {-1, -1});
+            vector<pair<int, int>> q;   // (vertex, source)
+            bool found = false;
+            auto reach = [&](int v, int source) {
+                auto& known = origins[v];
+                if (known[0] == source || known[1] == source || known[1] != -1) {
+                    return;
+                }
+                known[known[0] == -1 ? 0 : 1] = source;
+                q.emplace_back(v, source);
+                found = found || (is_accepting[v] && v != source);
+            };
+            for (int source : denseStartingVertices(*graph)) {
+                for (int i = graph->offsets[source]; i < graph->offsets[source + 1] && !found; ++i) {
+                    reach(graph->targets[i], source);
+                }
+            }
+            for (size_t head = 0; head < q.size() && !found; ++head) {
+                auto [v, source] = q[head];
+                for (int i = graph->offsets[v]; i < graph->offsets[v + 1] && !found; ++i) {
+                    reach(graph->targets[i], source);
+                }
+            }
+            END_LOCAL();
+            return found;
+        }
+
+        // PG() with the per-source BFS spread over a thread pool. Sources are
+        // claimed dynamically in small chunks; each worker keeps its own visited
+        // set and queue, and writes into the result slot of its source, which is
+        // created up front, so no lock is taken while merging.
+        UnorderedReachablePairs PG_Parallel(int threads = 0) {
+            unordered_map<int, unordered_set<int>> result;
+            if (starting_vertices.empty() || accepting_vertices.empty()) {
+                return UnorderedReachablePairs();
+            }
+            START_LOCAL("BFS parallel");
+            shared_ptr<const CSRGraph> graph = denseView();
+            int n = graph->numVertices();
+
+            vector<char> is_accepting(n, 0);
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    is_accepting[dense] = 1;
+                }
+            }
+
+            vector<pair<int, unordered_set<int>*>> sources;
+            for (int start : starting_vertices) {
+                sources.push_back({graph->denseId(start), &result[start]});
+            }
+
+            ThreadPool pool(threads);
+            vector<EpochVisitedSet> visited(pool.size());
+            vector<vector<int>> queues(pool.size());
+            pool.parallelFor(sources.size(), 16, [&](size_t i, int worker) {
+                auto [start, accept_nodes] = sources[i];
+                if (start < 0) {
+                    return;
+                }
+                EpochVisitedSet& seen = visited[worker];
+                vector<int>& q = queues[worker];
+                if (seen.capacity() == 0) {
+                    seen.resize(n);
+                }
+                seen.clear();
+                q.clear();
+                q.push_back(start);
+                seen.insert(start);
+                for (size_t head = 0; head < q.size(); ++head) {
+                    int current = q[head];
+                    for (int e = graph->offsets[current]; e < graph->offsets[current + 1]; ++e) {
+                        int neighbor = graph->targets[e];
+                        if (seen.insert(neighbor)) {
+                            q.push_back(neighbor);
+                            if (is_accepting[neighbor]) {
+                                accept_nodes->insert(graph->originalId(neighbor));
+                            }
+                        }
+                    }
+                }
+            });
+            END_LOCAL();
+            return UnorderedReachablePairs(std::move(result));
+        }
+
+        // PG() with direction-optimizing BFS (Beamer et al.). A level is expanded
+        // top-down from the frontier while the frontier's out-edges are few;
+        // once they exceed 1/alpha of the edges still unexplored, levels are
+        // expanded bottom-up, with every unvisited vertex scanning its in-edges
+        // for a frontier vertex. It switches back once the frontier holds fewer
+        // than 1/beta of the vertices. Same answers as PG().
+        UnorderedReachablePairs PG_DirectionOptimizing(double alpha = 14, double beta = 24) {
+            unordered_map<int, unordered_set<int>> result;
+            if (starting_vertices.empty() || accepting_vertices.empty()) {
+                return UnorderedReachablePairs();
+            }
+            START_LOCAL("BFS direction-optimizing");
+            shared_ptr<const CSRGraph> graph = denseView();
+            shared_ptr<const CSRGraph> reverse = csr ? reverseDenseView() : make_shared<const CSRGraph>(graph->reversed());
+            int n = graph->numVertices();
+            long long m = graph->numEdges();
+
+            vector<bool> is_accepting(n, false);
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    is_accepting[dense] = true;
+                }
+            }
+
+            EpochVisitedSet visited(n);
+            EpochVisitedSet in_frontier(n);
+            vector<int> frontier, next;
+            long long top_down_levels = 0, bottom_up_levels = 0;
+
+            for (const auto& start : starting_vertices) {
+                unordered_set<int>& accept_nodes = result[start];
+                int dense_start = graph->denseId(start);
+                if (dense_start < 0) {
+                    continue;
+                }
+                visited.clear();
+                visited.insert(dense_start);
+                frontier.assign(1, dense_start);
+                long long unexplored_edges = m - graph->outDegree(dense_start);
+                bool bottom_up = false;
+
+                auto discover = [&](int v) {
+                    next.push_back(v);
+                    unexplored_edges -= graph->outDegree(v);
+                    if (is_accepting[v]) {
+                        accept_nodes.insert(graph->originalId(v));
+                    }
+                };
+
+                while (!frontier.empty()) {
+                    long long frontier_edges = 0;
+                    for (int v : frontier) {
+                        frontier_edges += graph->outDegree(v);
+                    }
+                    if (!bottom_up && frontier_edges > unexplored_edges / alpha) {
+                        bottom_up = true;
+                    } else if (bottom_up && frontier.size() < n / beta) {
+                        bottom_up = false;
+                    }
+
+                    next.clear();
+                    if (bottom_up) {
+                        bottom_up_levels++;
+                        in_frontier.clear();
+                        for (int v : frontier) {
+                            in_frontier.insert(v);
+                        }
+                        for (int v = 0; v < n; ++v) {
+                            if (visited.contains(v)) {
+                                continue;
+                            }
+                            for (int i = reverse->offsets[v]; i < reverse->offsets[v + 1]; ++i) {
+                                if (in_frontier.contains(reverse->targets[i])) {
+                                    visited.insert(v);
+                                    discover(v);
+                                    break;
+                                }
+                            }
+                        }
+                    } else {
+                        top_down_levels++;
+                        for (int v : frontier) {
+                            for (int i = graph->offsets[v]; i < graph->offsets[v + 1]; ++i) {
+                                if (visited.insert(graph->targets[i])) {
+                                    discover(graph->targets[i]);
+                                }
+                            }
+                        }
+                    }
+                    frontier.swap(next);
+                }
+            }
+            RECORD_STAT("BFS top-down levels", top_down_levels);
+            RECORD_STAT("BFS bottom-up levels", bottom_up_levels);
+            END_LOCAL();
+            return UnorderedReachablePairs(result);
+        }
+
+        // PG() over the condensation of the graph: every vertex of a strongly
+        // connected component reaches the same set, so reachability is computed
+        // once per component on the DAG of components and expanded to the
+        // starting vertices afterwards. Same answers as PG().
+        UnorderedReachablePairs PG_Condensed() {
+            unordered_map<int, unordered_set<int>> result;
+            if (starting_vertices.empty() || accepting_vertices.empty()) {
+                return UnorderedReachablePairs();
+            }
+            shared_ptr<const CSRGraph> graph = denseView();
+            vector<bool> is_accepting(graph->numVertices(), false);
+            for (int v : accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    is_accepting[dense] = true;
+                }
+            }
+
+            START_LOCAL("BFS condensed (SCC)");
+            Condensation condensation(*graph);
+            END_LOCAL();
+            RECORD_STAT("BFS condensed components", condensation.numComponents());
+
+            START_LOCAL("BFS condensed (reach)");
+            vector<vector<int>> reach = condensation.reachableMarked(is_accepting);
+            END_LOCAL();
+
+            START_LOCAL("BFS condensed (expand)");
+            for (const auto& start : starting_vertices) {
+                unordered_set<int>& accept_nodes = result[start];
+                int dense_start = graph->denseId(start);
+                if (dense_start < 0) {
+                    continue;
+                }
+                // like PG(), never report the start itself
+                for (int z : reach[condensation.componentOf(dense_start)]) {
+                    if (z != dense_start) {
+                        accept_nodes.insert(graph->originalId(z));
+                    }
+                }
+            }
+            END_LOCAL();
+            return UnorderedReachablePairs(result);
+        }
+
         NFA constructDFA(int start_vertex, set<int> accepting_vertices) {
             NFA nfa;
             std::map<int, State*> vertex_to_state;
     
             // Create NFA states for each vertex
-            for (int vertex : vertices) {
+            forEachVertex([&](int vertex) {
                 vertex_to_state[vertex] = nfa.create_state(vertex);
-            }
+            });
     
             // Add transitions to the NFA
-            for (const auto& [src, edges] : adjList) {
-                State* from_state = vertex_to_state[src];
-                for (const Edge& edge : edges) {
-                    State* to_state = vertex_to_state[edge.dest];
-                    nfa.add_transition(from_state, to_state, edge.label);
-                }
-            }
+            forEachEdge([&](int src, LabelID label, int dest) {
+                nfa.add_transition(vertex_to_state[src], vertex_to_state[dest], label);
+            });
     
             // Set the start state
             nfa.start_state = vertex_to_state[start_vertex];
@@ -311,6 +1118,7 @@ namespace rpqdb{
             return nfa.getDFA();
         }
     
+        // Only populated while the graph is not sealed
         const unordered_map<int, vector<Edge>>& getAdjacencyList() const {
             return adjList;
         }
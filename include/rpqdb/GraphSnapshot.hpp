@@ -0,0 +1,261 @@
+#ifndef RPQDB_GraphSnapshot_H
+#define RPQDB_GraphSnapshot_H
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rpqdb/CSRGraph.hpp"
+#include "rpqdb/Labels.hpp"
+
+namespace rpqdb {
+    using namespace std;
+
+    // Binary snapshot of a sealed graph, laid out so that the CSR arrays can be
+    // served directly from a read-only memory mapping.
+    //
+    // Layout (native byte order, every section padded to 8 bytes):
+    //   SnapshotHeader
+    //   int32   vertex_ids[num_vertices]
+    //   int32   offsets[num_vertices + 1]
+    //   int32   targets[num_edges]
+    //   int32   labels[num_edges]
+    //   int32   starting[num_starting]
+    //   int32   accepting[num_accepting]
+    //   uint64  label_offsets[num_labels + 1]
+    //   char    label_chars[label_offsets[num_labels]]
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t num_vertices;
+        uint64_t num_edges;
+        uint64_t num_starting;
+        uint64_t num_accepting;
+        uint64_t num_labels;
+        uint64_t label_bytes;
+    };
+
+    static const char SNAPSHOT_MAGIC[8] = {'R', 'P', 'Q', 'D', 'B', 'S', 'N', 'P'};
+    // Version 2: edges of each vertex are sorted by (label, target)
+    static const uint32_t SNAPSHOT_VERSION = 2;
+    static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+    // Read-only mapping of a whole file, unmapped on destruction
+    class MappedFile {
+    private:
+        void* addr = MAP_FAILED;
+        size_t length = 0;
+
+    public:
+        explicit MappedFile(const string& filename) {
+            int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw runtime_error("Unable to open file " + filename);
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                close(fd);
+                throw runtime_error("Unable to stat file " + filename);
+            }
+            length = st.st_size;
+            if (length > 0) {
+                addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            close(fd);
+            if (length > 0 && addr == MAP_FAILED) {
+                throw runtime_error("Unable to map file " + filename);
+            }
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            if (addr != MAP_FAILED) {
+                munmap(addr, length);
+            }
+        }
+
+        const char* data() const {
+            return addr == MAP_FAILED ? nullptr : static_cast<const char*>(addr);
+        }
+
+        size_t size() const {
+            return length;
+        }
+    };
+
+    // Contents of a snapshot once loaded; csr may point into the mapping
+    struct GraphSnapshot {
+        CSRGraph csr;
+        unordered_set<int> starting_vertices;
+        unordered_set<int> accepting_vertices;
+
+        static size_t padded(size_t bytes) {
+            return (bytes + 7) & ~size_t(7);
+        }
+
+        static void write(const string& filename, const CSRGraph& csr,
+                          const unordered_set<int>& starting_vertices,
+                          const unordered_set<int>& accepting_vertices) {
+            ofstream file(filename, ios::binary | ios::trunc);
+            if (!file.is_open()) {
+                throw runtime_error("Unable to create snapshot " + filename);
+            }
+
+            // The whole label dictionary is stored so that label ids stay valid
+            const LabelDictionary& dictionary = LabelDictionary::global();
+            vector<uint64_t> label_offsets(dictionary.size() + 1, 0);
+            for (int i = 0; i < dictionary.size(); ++i) {
+                label_offsets[i + 1] = label_offsets[i] + dictionary.name(i).size();
+            }
+
+            vector<int> starting(starting_vertices.begin(), starting_vertices.end());
+            vector<int> accepting(accepting_vertices.begin(), accepting_vertices.end());
+            sort(starting.begin(), starting.end());
+            sort(accepting.begin(), accepting.end());
+
+            SnapshotHeader header = {};
+            memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+            header.version = SNAPSHOT_VERSION;
+            header.byte_order = SNAPSHOT_BYTE_ORDER;
+            header.num_vertices = csr.numVertices();
+            header.num_edges = csr.numEdges();
+            header.num_starting = starting.size();
+            header.num_accepting = accepting.size();
+            header.num_labels = dictionary.size();
+            header.label_bytes = label_offsets.back();
+
+            auto write_section = [&](const void* data, size_t bytes) {
+                static const char zeros[8] = {};
+                file.write(static_cast<const char*>(data), bytes);
+                file.write(zeros, padded(bytes) - bytes);
+            };
+
+            write_section(&header, sizeof(header));
+            write_section(csr.vertex_ids.data(), csr.vertex_ids.size() * sizeof(int));
+            write_section(csr.offsets.data(), csr.offsets.size() * sizeof(int));
+            write_section(csr.targets.data(), csr.targets.size() * sizeof(int));
+            write_section(csr.labels.data(), csr.labels.size() * sizeof(LabelID));
+            write_section(starting.data(), starting.size() * sizeof(int));
+            write_section(accepting.data(), accepting.size() * sizeof(int));
+            write_section(label_offsets.data(), label_offsets.size() * sizeof(uint64_t));
+            for (int i = 0; i < dictionary.size(); ++i) {
+                file.write(dictionary.name(i).data(), dictionary.name(i).size());
+            }
+            if (!file) {
+                throw runtime_error("Failed to write snapshot " + filename);
+            }
+        }
+
+        // Map a snapshot written by write(). The CSR arrays are served from the
+        // mapped pages; only the label array is copied, and only if the ids stored
+        // in the file disagree with the current global dictionary.
+        static GraphSnapshot load(const string& filename) {
+            auto file = make_shared<MappedFile>(filename);
+            const char* base = file->data();
+            size_t pos = 0;
+
+            auto section = [&](size_t bytes) -> const char* {
+                if (pos + bytes > file->size()) {
+                    throw runtime_error("Truncated snapshot " + filename);
+                }
+                const char* ptr = base + pos;
+                pos += padded(bytes);
+                return ptr;
+            };
+
+            SnapshotHeader header;
+            memcpy(&header, section(sizeof(header)), sizeof(header));
+            if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+                throw runtime_error("Not a graph snapshot: " + filename);
+            }
+            if (header.version != SNAPSHOT_VERSION) {
+                throw runtime_error("Unsupported snapshot version " + to_string(header.version));
+            }
+            if (header.byte_order != SNAPSHOT_BYTE_ORDER) {
+                throw runtime_error("Snapshot was written with a different byte order");
+            }
+
+            size_t n = header.num_vertices;
+            size_t m = header.num_edges;
+            auto ints = [&](size_t count) {
+                if (count > file->size() / sizeof(int)) {
+                    throw runtime_error("Truncated snapshot " + filename);
+                }
+                return ArrayView<int>(reinterpret_cast<const int*>(section(count * sizeof(int))), count);
+            };
+
+            GraphSnapshot snapshot;
+            snapshot.csr.vertex_ids = ints(n);
+            snapshot.csr.offsets = ints(n + 1);
+            snapshot.csr.targets = ints(m);
+            snapshot.csr.labels = ints(m);
+            // Every index used below must be in range: offsets ascend from 0 to
+            // m, targets are dense vertices and labels stored dictionary ids
+            bool valid = snapshot.csr.offsets[0] == 0 && snapshot.csr.offsets[n] == int(m);
+            for (size_t v = 0; valid && v < n; ++v) {
+                valid = snapshot.csr.offsets[v] <= snapshot.csr.offsets[v + 1];
+            }
+            for (size_t i = 0; valid && i < m; ++i) {
+                valid = snapshot.csr.targets[i] >= 0 && size_t(snapshot.csr.targets[i]) < n
+                        && snapshot.csr.labels[i] >= 0 && size_t(snapshot.csr.labels[i]) < header.num_labels;
+            }
+            if (!valid) {
+                throw runtime_error("Corrupt snapshot " + filename);
+            }
+            ArrayView<int> starting = ints(header.num_starting);
+            ArrayView<int> accepting = ints(header.num_accepting);
+            if (header.num_labels >= file->size() / sizeof(uint64_t)) {
+                throw runtime_error("Truncated snapshot " + filename);
+            }
+            const uint64_t* label_offsets = reinterpret_cast<const uint64_t*>(section((header.num_labels + 1) * sizeof(uint64_t)));
+            const char* label_chars = section(header.label_bytes);
+            valid = label_offsets[0] == 0 && label_offsets[header.num_labels] == header.label_bytes;
+            for (size_t i = 0; valid && i < header.num_labels; ++i) {
+                valid = label_offsets[i] <= label_offsets[i + 1];
+            }
+            if (!valid) {
+                throw runtime_error("Corrupt snapshot " + filename);
+            }
+
+            snapshot.starting_vertices.insert(starting.begin(), starting.end());
+            snapshot.accepting_vertices.insert(accepting.begin(), accepting.end());
+
+            // Re-intern the stored labels; remap only if ids moved
+            vector<LabelID> remap(header.num_labels);
+            bool identity = true;
+            for (size_t i = 0; i < header.num_labels; ++i) {
+                string name(label_chars + label_offsets[i], label_offsets[i + 1] - label_offsets[i]);
+                remap[i] = internLabel(name);
+                identity = identity && remap[i] == LabelID(i);
+            }
+
+            if (identity) {
+                snapshot.csr.storage = file;
+            } else {
+                auto labels = make_shared<vector<LabelID>>(m);
+                for (size_t i = 0; i < m; ++i) {
+                    (*labels)[i] = remap[snapshot.csr.labels[i]];
+                }
+                snapshot.csr.labels = *labels;
+                // keep both the mapping and the remapped labels alive
+                snapshot.csr.storage = make_shared<pair<shared_ptr<MappedFile>, shared_ptr<vector<LabelID>>>>(file, labels);
+            }
+            return snapshot;
+        }
+    };
+} // namespace rpqdb
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef RPQDB_Labels_H
+#define RPQDB_Labels_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace rpqdb {
+	using namespace std;
+
+	typedef int LabelID;
+
+	// Interns edge/transition labels into compact integer ids so that graphs,
+	// NFAs/DFAs and products compare integers. Strings are only looked up again
+	// for output. The empty label (ε) always has id EPSILON.
+	class LabelDictionary {
+	private:
+		vector<string> names;
+		unordered_map<string, LabelID> ids;
+
+	public:
+		static constexpr LabelID EPSILON = 0;
+		static constexpr LabelID NONE = -1;
+
+		LabelDictionary() {
+			intern("");
+		}
+
+		LabelID intern(const string& label) {
+			auto [it, inserted] = ids.try_emplace(label, names.size());
+			if (inserted) {
+				names.push_back(label);
+			}
+			return it->second;
+		}
+
+		// Returns NONE if the label has never been interned
+		LabelID find(const string& label) const {
+			auto it = ids.find(label);
+			return it == ids.end() ? NONE : it->second;
+		}
+
+		const string& name(LabelID id) const {
+			return names[id];
+		}
+
+		// Number of interned labels, including ε
+		int size() const {
+			return names.size();
+		}
+
+		// Dictionary shared by all graphs and automata
+		static LabelDictionary& global() {
+			static LabelDictionary dictionary;
+			return dictionary;
+		}
+	};
+
+	inline LabelID internLabel(const string& label) {
+		return LabelDictionary::global().intern(label);
+	}
+
+	inline const string& labelName(LabelID id) {
+		return LabelDictionary::global().name(id);
+	}
+} // namespace rpqdb
+
+#endif
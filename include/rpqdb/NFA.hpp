@@ -12,6 +12,8 @@
 #include <iostream>
 #include <memory>
 
+#include "rpqdb/Labels.hpp"
+
 namespace rpqdb {
 	using namespace std;
 	
@@ -20,8 +22,9 @@ namespace rpqdb {
 	typedef int StateID;
 	
 	// Transition structure to pair label with target state
+	// Labels are interned (see LabelDictionary); ε transitions use EPSILON
 	struct Transition {
-		string label;
+		LabelID label;
 		State* target;
 	};
 	
@@ -54,17 +57,17 @@ namespace rpqdb {
 			map<set<State*>, State*> subset_to_dfa_state;
 			
 			// Get all possible transition labels from the NFA (excluding ε)
-			set<string> all_labels;
+			set<LabelID> all_labels;
 			for (const auto& state : states) {
 				for (const auto& trans : state->transitions) {
-					if (!trans.label.empty()) {
+					if (trans.label != LabelDictionary::EPSILON) {
 						all_labels.insert(trans.label);
 					}
 				}
 			}
 	
 			// Helper function to get next states for a given set of states and input
-			auto label_closure = [](const set<State*>& states, const string& input) -> set<State*> {
+			auto label_closure = [](const set<State*>& states, LabelID input) -> set<State*> {
 				set<State*> result;
 				for (State* s : states) {
 					for (const auto& trans : s->transitions) {
@@ -98,7 +101,7 @@ namespace rpqdb {
 				State* current_dfa_state = subset_to_dfa_state[current_subset];
 	
 				// Process each possible input symbol
-				for (const string& label : all_labels) {
+				for (LabelID label : all_labels) {
 					set<State*> next_states = label_closure(current_subset, label);
 					if (next_states.empty()) continue;
 					
@@ -153,10 +156,14 @@ namespace rpqdb {
 		}
 	
 		// Adds a transition between states
-		void add_transition(State* from, State* to, const string& label) {
+		void add_transition(State* from, State* to, LabelID label) {
 			dirty = true;
 			from->transitions.push_back({label, to});
 		}
+
+		void add_transition(State* from, State* to, const string& label) {
+			add_transition(from, to, internLabel(label));
+		}
 	
 		// Merges another NFA into this one (basic implementation)
 		// rvalue reference to an NFA object that enables move semantics 
@@ -179,7 +186,7 @@ namespace rpqdb {
 				stack.pop();
 	
 				for (const auto& trans : current->transitions) {
-					if (trans.label.empty() && closure.find(trans.target) == closure.end()) {
+					if (trans.label == LabelDictionary::EPSILON && closure.find(trans.target) == closure.end()) {
 						closure.insert(trans.target);
 						stack.push(trans.target);
 					}
@@ -199,6 +206,34 @@ namespace rpqdb {
 			return std::move(*dfa);
 		}
 	
+		// NFA of the reversed language: every transition is flipped, the old
+		// start state becomes the only accepting state, and a new start state
+		// has ε-transitions to the old accepting states. A word labels a path
+		// from u to v in the data graph iff its reverse labels the reversed
+		// path from v to u, so the reverse NFA evaluates a query backwards.
+		NFA reverse() const {
+			NFA result;
+			map<const State*, State*> mirror;
+			for (const auto& state : states) {
+				mirror[state.get()] = result.create_state();
+			}
+			State* start = result.create_state();
+			for (const auto& state : states) {
+				for (const auto& trans : state->transitions) {
+					result.add_transition(mirror[trans.target], mirror[state.get()], trans.label);
+				}
+				if (state->is_accepting) {
+					result.add_transition(start, mirror[state.get()], LabelDictionary::EPSILON);
+				}
+			}
+			result.start_state = start;
+			if (start_state) {
+				result.end_state = mirror[start_state];
+				result.end_state->is_accepting = true;
+			}
+			return result;
+		}
+	
 		// Apply to DFAs
 		NFA product(NFA& other) {
 			NFA result;
@@ -290,7 +325,7 @@ namespace rpqdb {
 	
 				// Process ε-transitions (transitions with an empty label)
 				for (const auto& transition : current_state->transitions) {
-					if (transition.label.empty()) {
+					if (transition.label == LabelDictionary::EPSILON) {
 						// Move to the target state without consuming any input
 						queue.push({transition.target, current_position});
 					}
@@ -300,7 +335,7 @@ namespace rpqdb {
 				if (current_position < input.size()) {
 					char current_symbol = input[current_position];
 					for (const auto& transition : current_state->transitions) {
-						if (!transition.label.empty() && transition.label[0] == current_symbol) {
+						if (transition.label != LabelDictionary::EPSILON && labelName(transition.label)[0] == current_symbol) {
 							// Move to the target state and consume the current input symbol
 							queue.push({transition.target, current_position + 1});
 						}
@@ -328,7 +363,7 @@ namespace rpqdb {
 				cout << ":\n";
 	
 				for (const auto& trans : state->transitions) {
-					cout << "  --" << trans.label << "--> State " << trans.target << "\n";
+					cout << "  --" << labelName(trans.label) << "--> State " << trans.target << "\n";
 				}
 			}
 		}
@@ -520,6 +555,38 @@ namespace rpqdb {
 					break;
 				}
 	
+				// One or more (+): the Kleene star without the ε-transition for zero repetitions
+				// Zero or one (?): the Kleene star without the ε-transition for repetition
+				case '+':
+				case '?': {
+					if (nfa_stack.empty()) {
+						throw runtime_error("Invalid postfix expression: insufficient operands for quantifier");
+					}
+					NFA nfa1 = std::move(nfa_stack.top());
+					nfa_stack.pop();
+					NFA result;
+					State* start = result.create_state();
+					State* end = result.create_state();
+					end->is_accepting = true;
+	
+					result.merge(std::move(nfa1));
+	
+					result.add_transition(start, nfa1.start_state, "");
+					nfa1.end_state->is_accepting = false;
+					result.add_transition(nfa1.end_state, end, "");
+					if (ch == '+') {
+						result.add_transition(nfa1.end_state, nfa1.start_state, "");
+					} else {
+						result.add_transition(start, end, "");
+					}
+	
+					result.start_state = start;
+					result.end_state = end;
+	
+					nfa_stack.push(std::move(result));
+					break;
+				}
+	
 				// Default case: single character
 				default: {
 					NFA nfa = NFA::create_basic(string(1, ch));
@@ -0,0 +1,114 @@
+#ifndef RPQDB_ParallelLoader_H
+#define RPQDB_ParallelLoader_H
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <unordered_map>
+
+#include "rpqdb/Labels.hpp"
+#include "rpqdb/GraphSnapshot.hpp"
+
+namespace rpqdb {
+    using namespace std;
+
+    // Edges parsed from one byte range of an edge-list file. Labels are numbered
+    // per chunk (views into the mapped file) and interned globally after the join.
+    struct EdgeChunk {
+        vector<int> sources;
+        vector<int> local_labels;
+        vector<int> dests;
+        vector<string_view> label_names;
+        vector<int> starting;   // 'a' self-loops (labelled files only)
+        vector<int> accepting;  // 'c' self-loops (labelled files only)
+
+        // Same leniency as stoi: skips leading blanks, stops at the first non-digit
+        static int scanInt(const char* p, const char* end) {
+            while (p < end && (*p == ' ' || *p == '\t')) ++p;
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                negative = *p == '-';
+                ++p;
+            }
+            int value = 0;
+            while (p < end && *p >= '0' && *p <= '9') {
+                value = value * 10 + (*p - '0');
+                ++p;
+            }
+            return negative ? -value : value;
+        }
+
+        // Parse lines "v1<sep>label<sep>v2" in [begin, end); the label spans the
+        // first and the last occurrence of the separator, as in buildFromFile()
+        void parse(const char* begin, const char* end, string_view separator, bool labelled) {
+            unordered_map<string_view, int> label_index;
+            const char* line = begin;
+            while (line < end) {
+                const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+                if (eol == nullptr) {
+                    eol = end;
+                }
+                string_view text(line, eol - line);
+                size_t pos1 = text.find(separator);
+                size_t pos2 = text.rfind(separator);
+                if (pos1 != string_view::npos && pos1 != pos2) {
+                    int v1 = scanInt(line, line + pos1);
+                    string_view label = text.substr(pos1 + separator.size(), pos2 - pos1 - separator.size());
+                    int v2 = scanInt(line + pos2 + separator.size(), eol);
+                    if (labelled && v1 == v2 && label == "a") {
+                        starting.push_back(v1);
+                    } else if (labelled && v1 == v2 && label == "c") {
+                        accepting.push_back(v1);
+                    } else {
+                        auto [it, inserted] = label_index.try_emplace(label, label_names.size());
+                        if (inserted) {
+                            label_names.push_back(label);
+                        }
+                        sources.push_back(v1);
+                        local_labels.push_back(it->second);
+                        dests.push_back(v2);
+                    }
+                }
+                line = eol + 1;
+            }
+        }
+    };
+
+    // Split the file into one byte range per thread (cut on line boundaries)
+    // and parse the ranges concurrently. The returned chunks are in file order
+    // and reference the mapping, which must outlive them.
+    static vector<EdgeChunk> parseEdgeChunks(const MappedFile& file, const string& separator, bool labelled, int threads) {
+        if (threads <= 0) {
+            threads = max(1u, thread::hardware_concurrency());
+        }
+        const char* data = file.data();
+        size_t size = file.size();
+
+        vector<const char*> bounds = {data};
+        for (int t = 1; t < threads; ++t) {
+            const char* cut = max(bounds.back(), data + size * t / threads);
+            const char* eol = cut < data + size ? static_cast<const char*>(memchr(cut, '\n', data + size - cut)) : nullptr;
+            if (eol == nullptr) {
+                break;
+            }
+            bounds.push_back(eol + 1);
+        }
+        bounds.push_back(data + size);
+
+        vector<EdgeChunk> chunks(bounds.size() - 1);
+        vector<thread> workers;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            workers.emplace_back([&, i]() {
+                chunks[i].parse(bounds[i], bounds[i + 1], separator, labelled);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        return chunks;
+    }
+} // namespace rpqdb
+
+#endif
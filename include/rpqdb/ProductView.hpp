@@ -0,0 +1,106 @@
+#ifndef RPQDB_ProductView_H
+#define RPQDB_ProductView_H
+
+#include <cstdint>
+#include <vector>
+
+#include "rpqdb/NFA.hpp"
+#include "rpqdb/CSRGraph.hpp"
+#include "rpqdb/DFATable.hpp"
+
+namespace rpqdb {
+    using namespace std;
+
+    // Product vertices (DFA state, data vertex) are encoded as state * n + v,
+    // where n is the number of data vertices and v a dense data vertex id
+    typedef int64_t ProductVertex;
+
+    // The product of a DFA and a sealed data graph, never materialized:
+    // successors and predecessors of a product vertex are generated on demand
+    // from the compiled DFA table and the label runs of the data graph adjacency
+    // (forward CSR for successors, transposed CSR for predecessors).
+    class ProductView {
+    private:
+        const CSRGraph& data;
+        const CSRGraph& reverse_data;
+        DFATable table;
+
+    public:
+        ProductView(const CSRGraph& data, const CSRGraph& reverse_data, NFA& dfa)
+            : data(data), reverse_data(reverse_data), table(dfa) {}
+
+        int numStates() const {
+            return table.numStates();
+        }
+
+        int numDataVertices() const {
+            return data.numVertices();
+        }
+
+        const CSRGraph& dataGraph() const {
+            return data;
+        }
+
+        const DFATable& dfaTable() const {
+            return table;
+        }
+
+        ProductVertex encode(int state, int dense_vertex) const {
+            return ProductVertex(state) * data.numVertices() + dense_vertex;
+        }
+
+        int stateOf(ProductVertex p) const {
+            return p / data.numVertices();
+        }
+
+        int vertexOf(ProductVertex p) const {
+            return p % data.numVertices();
+        }
+
+        int startState() const {
+            return table.startState();
+        }
+
+        bool isAcceptingState(int state) const {
+            return table.isAccepting(state);
+        }
+
+        bool isAccepting(ProductVertex p) const {
+            return table.isAccepting(stateOf(p));
+        }
+
+        bool hasIncomingTransitions(int state) const {
+            return table.hasIncomingTransitions(state);
+        }
+
+        // f(successor)
+        template<typename F>
+        void forEachSuccessor(ProductVertex p, F&& f) const {
+            int q = stateOf(p);
+            data.forEachLabelRun(vertexOf(p), [&](LabelID label, int begin, int end) {
+                int next = table.next(q, label);
+                if (next == DFATable::NONE) {
+                    return;
+                }
+                for (int i = begin; i < end; ++i) {
+                    f(encode(next, data.targets[i]));
+                }
+            });
+        }
+
+        // f(predecessor)
+        template<typename F>
+        void forEachPredecessor(ProductVertex p, F&& f) const {
+            int q = stateOf(p);
+            reverse_data.forEachLabelRun(vertexOf(p), [&](LabelID label, int begin, int end) {
+                table.forEachPrevious(q, label, [&](int previous) {
+                    for (int i = begin; i < end; ++i) {
+                        f(encode(previous, reverse_data.targets[i]));
+                    }
+                });
+            });
+        }
+    };
+} // namespace rpqdb
+
+#endif
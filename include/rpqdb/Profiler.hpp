@@ -59,6 +59,9 @@ namespace rpqdb {
         // Map for named events (must end with same name)
         static unordered_map<string, steady_clock::time_point> active_events;
 
+        // Values reported by the evaluators (chosen parameters, sizes)
+        static unordered_map<string, vector<double>> stats;
+
     public:
         const static bool verbose = true;
 
@@ -125,6 +128,22 @@ namespace rpqdb {
             active_events.erase(it);
         }
     
+        // Record a named value, e.g. a parameter chosen at run time
+        static void record_stat(const string& name, double value) {
+            lock_guard<mutex> lock(mtx);
+            if (verbose) {
+                cout << log_time_human(steady_clock::now()) << "Stat " << name << " = " << value << endl;
+            }
+            stats[name].push_back(value);
+        }
+
+        // All values recorded under name, oldest first
+        static vector<double> get_stat(const string& name) {
+            lock_guard<mutex> lock(mtx);
+            auto it = stats.find(name);
+            return it == stats.end() ? vector<double>() : it->second;
+        }
+
         static void print_stats() {
             lock_guard<mutex> lock(mtx);
             cout << "\n===== Profiling Results =====\n";
@@ -141,6 +160,13 @@ namespace rpqdb {
                      << total_ms << "ms total, "
                      << total_ms/events.size() << "ms avg\n";
             }
+            for (const auto& [name, values] : stats) {
+                cout << name << ":";
+                for (double value : values) {
+                    cout << " " << value;
+                }
+                cout << "\n";
+            }
         }
 
         static void export_to_file(const string& new_filename = "profile.dat") {
@@ -189,6 +215,7 @@ namespace rpqdb {
             profile_data.clear();
             while (!local_stack.empty()) local_stack.pop();
             active_events.clear();
+            stats.clear();
         }
     };
     
@@ -197,6 +224,7 @@ namespace rpqdb {
     mutex EventProfiler::mtx;
     thread_local stack<pair<string, steady_clock::time_point>> EventProfiler::local_stack;
     unordered_map<string, steady_clock::time_point> EventProfiler::active_events;
+    unordered_map<string, vector<double>> EventProfiler::stats;
     
     // Macros for cleaner syntax
     #define START_LOCAL(name) EventProfiler::start_local(name)
@@ -205,6 +233,8 @@ namespace rpqdb {
     #define START_EVENT(name) EventProfiler::start_event(name)
     #define END_EVENT(name) EventProfiler::end_event(name)
 
+    #define RECORD_STAT(name, value) EventProfiler::record_stat(name, value)
+
     #define IGNORE(...)
     #define VERSIONED_IMPLEMENTATION(...)
 }; 
@@ -0,0 +1,213 @@
+#ifndef RPQDB_RegexProgram_H
+#define RPQDB_RegexProgram_H
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "rpqdb/NFA.hpp"
+#include "rpqdb/DFATable.hpp"
+#include "rpqdb/Labels.hpp"
+
+namespace rpqdb {
+    using namespace std;
+
+    // R_head(X, Z) :- E_label(X, Y), R_body(Y, Z).
+    struct RegexRule {
+        int head;
+        LabelID label;
+        int body;
+    };
+
+    // Linear datalog program of a regular path query, compiled from the DFA
+    // of the regex. There is one relation R_q per state q of the minimized
+    // DFA, holding (X, Z) when a path from X to Z spells a word that leads
+    // from q to an accepting state; the answer is R_0, the start state. Every
+    // transition q --l--> p becomes the rule R_q(X, Z) :- E_l(X, Y), R_p(Y, Z)
+    // over the edges E_l labelled l, and every accepting q the base rule
+    // R_q(X, X). For a b* c this is the program hardcoded in PG(Graph&&).
+    // States that cannot reach an accepting state never derive a fact and are
+    // left out; equivalent states (Moore's partition refinement) share one
+    // relation, since getDFA() does not minimize.
+    class RegexProgram {
+    private:
+        int num_relations = 1;
+        int num_labels = 0;
+        vector<int> next_relation;      // relation * num_labels + label -> body or NONE
+        vector<int> head_offsets;       // body * num_labels + label -> range in heads
+        vector<int> heads;
+        vector<bool> base;
+        vector<RegexRule> rules;
+
+    public:
+        static constexpr int NONE = DFATable::NONE;
+
+        explicit RegexProgram(NFA& dfa) {
+            DFATable table(dfa);
+            int k = table.numStates();
+            num_labels = table.numLabels();
+
+            vector<bool> useful(k, false);
+            queue<int> worklist;
+            for (int q = 0; q < k; ++q) {
+                if (table.isAccepting(q)) {
+                    useful[q] = true;
+                    worklist.push(q);
+                }
+            }
+            while (!worklist.empty()) {
+                int q = worklist.front();
+                worklist.pop();
+                for (LabelID label = 0; label < num_labels; ++label) {
+                    table.forEachPrevious(q, label, [&](int p) {
+                        if (!useful[p]) {
+                            useful[p] = true;
+                            worklist.push(p);
+                        }
+                    });
+                }
+            }
+
+            // Refine {accepting, not accepting} until states in one class
+            // move to the same classes on every label
+            vector<int> cls(k, NONE);
+            size_t classes = 0;
+            for (int q = 0; q < k; ++q) {
+                if (useful[q]) {
+                    cls[q] = table.isAccepting(q);
+                }
+            }
+            while (true) {
+                map<vector<int>, int> signatures;
+                vector<int> refined(k, NONE);
+                for (int q = 0; q < k; ++q) {
+                    if (!useful[q]) {
+                        continue;
+                    }
+                    vector<int> signature{cls[q]};
+                    for (LabelID label = 0; label < num_labels; ++label) {
+                        int p = table.next(q, label);
+                        signature.push_back(p != NONE && useful[p] ? cls[p] : NONE);
+                    }
+                    refined[q] = signatures.emplace(signature, signatures.size()).first->second;
+                }
+                cls = std::move(refined);
+                if (signatures.size() == classes) {
+                    break;
+                }
+                classes = signatures.size();
+            }
+
+            // Relations numbered in BFS order from the start state's class
+            vector<int> relation(classes, NONE);
+            vector<int> representative;
+            if (useful[table.startState()]) {
+                queue<int> order;
+                relation[cls[table.startState()]] = 0;
+                representative.push_back(table.startState());
+                order.push(table.startState());
+                while (!order.empty()) {
+                    int q = order.front();
+                    order.pop();
+                    for (LabelID label = 0; label < num_labels; ++label) {
+                        int p = table.next(q, label);
+                        if (p != NONE && useful[p] && relation[cls[p]] == NONE) {
+                            relation[cls[p]] = representative.size();
+                            representative.push_back(p);
+                            order.push(p);
+                        }
+                    }
+                }
+            }
+            num_relations = max<size_t>(1, representative.size());
+
+            next_relation.assign(size_t(num_relations) * num_labels, NONE);
+            base.assign(num_relations, false);
+            for (int r = 0; r < int(representative.size()); ++r) {
+                int q = representative[r];
+                base[r] = table.isAccepting(q);
+                for (LabelID label = 0; label < num_labels; ++label) {
+                    int p = table.next(q, label);
+                    if (p != NONE && useful[p]) {
+                        next_relation[r * num_labels + label] = relation[cls[p]];
+                        rules.push_back({r, label, relation[cls[p]]});
+                    }
+                }
+            }
+            head_offsets.assign(size_t(num_relations) * num_labels + 1, 0);
+            for (const auto& rule : rules) {
+                head_offsets[rule.body * num_labels + rule.label + 1]++;
+            }
+            for (size_t i = 1; i < head_offsets.size(); ++i) {
+                head_offsets[i] += head_offsets[i - 1];
+            }
+            heads.resize(rules.size());
+            vector<int> fill(head_offsets.begin(), head_offsets.end() - 1);
+            for (const auto& rule : rules) {
+                heads[fill[rule.body * num_labels + rule.label]++] = rule.head;
+            }
+        }
+
+        // Compiles a regex in the syntax of re2post()
+        static RegexProgram fromRegex(const string& regex) {
+            NFA dfa = post2nfa(re2post(regex)).getDFA();
+            return RegexProgram(dfa);
+        }
+
+        int numRelations() const {
+            return num_relations;
+        }
+
+        int answerRelation() const {
+            return 0;
+        }
+
+        // R_relation(X, X) is a base fact for every vertex X
+        bool hasBaseRule(int relation) const {
+            return base[relation];
+        }
+
+        const vector<RegexRule>& getRules() const {
+            return rules;
+        }
+
+        // Body relation of the rule for (head, label), or NONE
+        int bodyOf(int head, LabelID label) const {
+            if (label >= num_labels) {
+                return NONE;
+            }
+            return next_relation[head * num_labels + label];
+        }
+
+        // f(head) for every rule R_head :- E_label, R_body
+        template<typename F>
+        void forEachHead(int body, LabelID label, F&& f) const {
+            if (label >= num_labels) {
+                return;
+            }
+            int slot = body * num_labels + label;
+            for (int i = head_offsets[slot]; i < head_offsets[slot + 1]; ++i) {
+                f(heads[i]);
+            }
+        }
+
+        string toString() const {
+            stringstream ss;
+            ss << "T(X, Z) :- R" << answerRelation() << "(X, Z).\n";
+            for (int q = 0; q < numRelations(); ++q) {
+                if (hasBaseRule(q)) {
+                    ss << "R" << q << "(X, X) :- V(X).\n";
+                }
+            }
+            for (const auto& rule : rules) {
+                ss << "R" << rule.head << "(X, Z) :- E_" << labelName(rule.label) << "(X, Y), R" << rule.body << "(Y, Z).\n";
+            }
+            return ss.str();
+        }
+    };
+} // namespace rpqdb
+
+#endif
@@ -0,0 +1,476 @@
+#ifndef RPQDB_RoaringSet_H
+#define RPQDB_RoaringSet_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace rpqdb {
+    using namespace std;
+
+    // Compressed bitmap set of non-negative ints in the style of Roaring
+    // bitmaps: values are split by their upper 16 bits into chunks of 64K, and
+    // each chunk is kept as whichever container is smallest for it:
+    //  - ARRAY:  sorted 16-bit values, while the chunk has at most 4096 values
+    //  - BITMAP: 65536 bits
+    //  - RUN:    (start, length - 1) pairs, only produced by runOptimize()
+    // Union, difference and intersection work chunk by chunk (merging arrays,
+    // OR-ing words otherwise), and cardinalities are kept per chunk, so large
+    // clustered sets combine far faster than hash sets or sorted vectors.
+    // Iteration is in ascending order. Can be used as the SetType of
+    // ReachablePairs.
+    class RoaringSet {
+    private:
+        static constexpr uint32_t ARRAY_MAX = 4096;
+        static constexpr size_t BITMAP_WORDS = 1024;
+
+        struct Container {
+            enum Kind : uint8_t { ARRAY, BITMAP, RUN };
+
+            uint16_t key = 0;
+            Kind kind = ARRAY;
+            uint32_t cardinality = 0;
+            vector<uint16_t> values;    // ARRAY: sorted values; RUN: (start, length - 1) pairs
+            vector<uint64_t> bits;      // BITMAP
+
+            static Container fromArray(uint16_t key, vector<uint16_t>&& values) {
+                if (values.size() > ARRAY_MAX) {
+                    vector<uint64_t> bits(BITMAP_WORDS, 0);
+                    for (uint16_t low : values) {
+                        bits[low / 64] |= uint64_t(1) << (low % 64);
+                    }
+                    return fromBits(key, std::move(bits));
+                }
+                Container c;
+                c.key = key;
+                c.kind = ARRAY;
+                c.cardinality = values.size();
+                c.values = std::move(values);
+                return c;
+            }
+
+            // Shrinks to an array when the bitmap is sparse enough
+            static Container fromBits(uint16_t key, vector<uint64_t>&& bits) {
+                uint32_t cardinality = 0;
+                for (uint64_t word : bits) {
+                    cardinality += __builtin_popcountll(word);
+                }
+                Container c;
+                c.key = key;
+                c.cardinality = cardinality;
+                if (cardinality <= ARRAY_MAX) {
+                    c.kind = ARRAY;
+                    c.values.reserve(cardinality);
+                    for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                        for (uint64_t word = bits[w]; word; word &= word - 1) {
+                            c.values.push_back(w * 64 + __builtin_ctzll(word));
+                        }
+                    }
+                } else {
+                    c.kind = BITMAP;
+                    c.bits = std::move(bits);
+                }
+                return c;
+            }
+
+            bool contains(uint16_t low) const {
+                switch (kind) {
+                    case ARRAY:
+                        return binary_search(values.begin(), values.end(), low);
+                    case BITMAP:
+                        return (bits[low / 64] >> (low % 64)) & 1;
+                    default: {
+                        // last run starting at or before low
+                        size_t lo = 0, hi = values.size() / 2;
+                        while (lo < hi) {
+                            size_t mid = (lo + hi) / 2;
+                            if (values[2 * mid] <= low) {
+                                lo = mid + 1;
+                            } else {
+                                hi = mid;
+                            }
+                        }
+                        return lo > 0 && uint32_t(low - values[2 * (lo - 1)]) <= values[2 * (lo - 1) + 1];
+                    }
+                }
+            }
+
+            template<typename F>
+            void forEach(F&& f) const {
+                switch (kind) {
+                    case ARRAY:
+                        for (uint16_t low : values) {
+                            f(low);
+                        }
+                        break;
+                    case BITMAP:
+                        for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                            for (uint64_t word = bits[w]; word; word &= word - 1) {
+                                f(uint16_t(w * 64 + __builtin_ctzll(word)));
+                            }
+                        }
+                        break;
+                    default:
+                        for (size_t r = 0; r < values.size(); r += 2) {
+                            for (uint32_t low = values[r]; low <= uint32_t(values[r]) + values[r + 1]; ++low) {
+                                f(uint16_t(low));
+                            }
+                        }
+                }
+            }
+
+            vector<uint64_t> toBits() const {
+                if (kind == BITMAP) {
+                    return bits;
+                }
+                vector<uint64_t> result(BITMAP_WORDS, 0);
+                forEach([&](uint16_t low) {
+                    result[low / 64] |= uint64_t(1) << (low % 64);
+                });
+                return result;
+            }
+
+            // Returns true if low was not in the container
+            bool insert(uint16_t low) {
+                if (kind == RUN) {
+                    *this = fromBits(key, toBits());
+                }
+                if (kind == BITMAP) {
+                    uint64_t bit = uint64_t(1) << (low % 64);
+                    if (bits[low / 64] & bit) {
+                        return false;
+                    }
+                    bits[low / 64] |= bit;
+                    cardinality++;
+                    return true;
+                }
+                auto it = lower_bound(values.begin(), values.end(), low);
+                if (it != values.end() && *it == low) {
+                    return false;
+                }
+                values.insert(it, low);
+                cardinality++;
+                if (cardinality > ARRAY_MAX) {
+                    *this = fromArray(key, std::move(values));
+                }
+                return true;
+            }
+
+            void runOptimize() {
+                vector<uint16_t> runs;
+                forEach([&](uint16_t low) {
+                    if (!runs.empty() && uint32_t(runs[runs.size() - 2]) + runs.back() + 1 == low) {
+                        runs.back()++;
+                    } else {
+                        runs.push_back(low);
+                        runs.push_back(0);
+                    }
+                });
+                size_t current = kind == BITMAP ? BITMAP_WORDS * 4 : values.size();
+                if (runs.size() < current) {
+                    kind = RUN;
+                    values = std::move(runs);
+                    bits = vector<uint64_t>();
+                }
+            }
+        };
+
+        enum Op { OR, AND, AND_NOT };
+
+        static Container combine(const Container& a, const Container& b, Op op) {
+            if (a.kind == Container::ARRAY && b.kind == Container::ARRAY) {
+                vector<uint16_t> out;
+                switch (op) {
+                    case OR:
+                        set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), back_inserter(out));
+                        break;
+                    case AND:
+                        set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), back_inserter(out));
+                        break;
+                    case AND_NOT:
+                        set_difference(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), back_inserter(out));
+                        break;
+                }
+                return Container::fromArray(a.key, std::move(out));
+            }
+            // a small array only needs lookups in the other container
+            if (op != OR && (a.kind == Container::ARRAY || (op == AND && b.kind == Container::ARRAY))) {
+                const Container& small = a.kind == Container::ARRAY ? a : b;
+                const Container& other = a.kind == Container::ARRAY ? b : a;
+                vector<uint16_t> out;
+                for (uint16_t low : small.values) {
+                    if (other.contains(low) == (op == AND)) {
+                        out.push_back(low);
+                    }
+                }
+                return Container::fromArray(a.key, std::move(out));
+            }
+            vector<uint64_t> x = a.toBits();
+            vector<uint64_t> y = b.toBits();
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+                switch (op) {
+                    case OR: x[w] |= y[w]; break;
+                    case AND: x[w] &= y[w]; break;
+                    case AND_NOT: x[w] &= ~y[w]; break;
+                }
+            }
+            return Container::fromBits(a.key, std::move(x));
+        }
+
+        static RoaringSet combine(const RoaringSet& a, const RoaringSet& b, Op op) {
+            RoaringSet result;
+            size_t i = 0, j = 0;
+            while (i < a.containers.size() || j < b.containers.size()) {
+                if (j == b.containers.size() || (i < a.containers.size() && a.containers[i].key < b.containers[j].key)) {
+                    if (op != AND) {
+                        result.containers.push_back(a.containers[i]);
+                    }
+                    i++;
+                } else if (i == a.containers.size() || b.containers[j].key < a.containers[i].key) {
+                    if (op == OR) {
+                        result.containers.push_back(b.containers[j]);
+                    }
+                    j++;
+                } else {
+                    Container c = combine(a.containers[i++], b.containers[j++], op);
+                    if (c.cardinality > 0) {
+                        result.containers.push_back(std::move(c));
+                    }
+                }
+            }
+            return result;
+        }
+
+        vector<Container> containers;   // sorted by key
+
+    public:
+        class const_iterator {
+        private:
+            const vector<Container>* containers = nullptr;
+            size_t ci = 0;
+            uint32_t pos = 0;       // ARRAY: index; BITMAP: low bits; RUN: index of the run
+            uint32_t offset = 0;    // RUN: offset in the run
+
+            // Moves to the first value at or after the current position
+            void settle() {
+                while (ci < containers->size()) {
+                    const Container& c = (*containers)[ci];
+                    if (c.kind == Container::ARRAY && pos < c.values.size()) {
+                        return;
+                    }
+                    if (c.kind == Container::RUN && 2 * pos < c.values.size()) {
+                        return;
+                    }
+                    if (c.kind == Container::BITMAP && pos < BITMAP_WORDS * 64) {
+                        size_t w = pos / 64;
+                        uint64_t word = c.bits[w] & (~uint64_t(0) << (pos % 64));
+                        while (word == 0 && ++w < BITMAP_WORDS) {
+                            word = c.bits[w];
+                        }
+                        if (word != 0) {
+                            pos = w * 64 + __builtin_ctzll(word);
+                            return;
+                        }
+                    }
+                    ci++;
+                    pos = 0;
+                    offset = 0;
+                }
+            }
+
+        public:
+            using iterator_category = forward_iterator_tag;
+            using value_type = int;
+            using difference_type = ptrdiff_t;
+            using pointer = const int*;
+            using reference = int;
+
+            const_iterator() = default;
+            const_iterator(const vector<Container>* containers, size_t ci) : containers(containers), ci(ci) {
+                settle();
+            }
+
+            int operator*() const {
+                const Container& c = (*containers)[ci];
+                uint32_t low = c.kind == Container::ARRAY ? c.values[pos]
+                             : c.kind == Container::BITMAP ? pos
+                             : c.values[2 * pos] + offset;
+                return int((uint32_t(c.key) << 16) | low);
+            }
+
+            const_iterator& operator++() {
+                const Container& c = (*containers)[ci];
+                if (c.kind == Container::RUN && offset < c.values[2 * pos + 1]) {
+                    offset++;
+                    return *this;
+                }
+                pos++;
+                offset = 0;
+                settle();
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            bool operator==(const const_iterator& other) const {
+                return ci == other.ci && pos == other.pos && offset == other.offset;
+            }
+
+            bool operator!=(const const_iterator& other) const {
+                return !(*this == other);
+            }
+        };
+
+        using iterator = const_iterator;
+        using value_type = int;
+
+        RoaringSet() = default;
+
+        RoaringSet(initializer_list<int> values) {
+            for (int v : values) {
+                insert(v);
+            }
+        }
+
+        template<typename It>
+        RoaringSet(It begin, It end) {
+            for (; begin != end; ++begin) {
+                insert(*begin);
+            }
+        }
+
+        // Returns true if v was not in the set
+        bool insert(int v) {
+            uint32_t u = uint32_t(v);
+            uint16_t key = u >> 16;
+            auto it = lower_bound(containers.begin(), containers.end(), key, [](const Container& c, uint16_t key) {
+                return c.key < key;
+            });
+            if (it == containers.end() || it->key != key) {
+                Container c;
+                c.key = key;
+                it = containers.insert(it, std::move(c));
+            }
+            return it->insert(u & 0xFFFF);
+        }
+
+        bool contains(int v) const {
+            uint32_t u = uint32_t(v);
+            uint16_t key = u >> 16;
+            auto it = lower_bound(containers.begin(), containers.end(), key, [](const Container& c, uint16_t key) {
+                return c.key < key;
+            });
+            return it != containers.end() && it->key == key && it->contains(u & 0xFFFF);
+        }
+
+        size_t count(int v) const {
+            return contains(v) ? 1 : 0;
+        }
+
+        size_t size() const {
+            size_t total = 0;
+            for (const auto& c : containers) {
+                total += c.cardinality;
+            }
+            return total;
+        }
+
+        bool empty() const {
+            return containers.empty();
+        }
+
+        const_iterator begin() const {
+            return const_iterator(&containers, 0);
+        }
+
+        const_iterator end() const {
+            return const_iterator(&containers, containers.size());
+        }
+
+        // f(v) for every value in ascending order; faster than iterators
+        template<typename F>
+        void forEach(F&& f) const {
+            for (const auto& c : containers) {
+                uint32_t high = uint32_t(c.key) << 16;
+                c.forEach([&](uint16_t low) {
+                    f(int(high | low));
+                });
+            }
+        }
+
+        // Keeps only the k smallest values
+        void truncate(size_t k) {
+            size_t kept = 0;
+            for (size_t i = 0; i < containers.size(); ++i) {
+                if (kept + containers[i].cardinality <= k) {
+                    kept += containers[i].cardinality;
+                    continue;
+                }
+                if (kept < k) {
+                    vector<uint16_t> first;
+                    size_t wanted = k - kept;
+                    containers[i].forEach([&](uint16_t low) {
+                        if (first.size() < wanted) {
+                            first.push_back(low);
+                        }
+                    });
+                    containers[i] = Container::fromArray(containers[i].key, std::move(first));
+                    i++;
+                }
+                containers.erase(containers.begin() + i, containers.end());
+                return;
+            }
+        }
+
+        // Converts chunks made of long consecutive ranges to run containers
+        void runOptimize() {
+            for (auto& c : containers) {
+                c.runOptimize();
+            }
+        }
+
+        RoaringSet& operator|=(const RoaringSet& other) {
+            *this = combine(*this, other, OR);
+            return *this;
+        }
+
+        RoaringSet& operator&=(const RoaringSet& other) {
+            *this = combine(*this, other, AND);
+            return *this;
+        }
+
+        RoaringSet& operator-=(const RoaringSet& other) {
+            *this = combine(*this, other, AND_NOT);
+            return *this;
+        }
+
+        friend RoaringSet operator|(const RoaringSet& a, const RoaringSet& b) {
+            return combine(a, b, OR);
+        }
+
+        friend RoaringSet operator&(const RoaringSet& a, const RoaringSet& b) {
+            return combine(a, b, AND);
+        }
+
+        friend RoaringSet operator-(const RoaringSet& a, const RoaringSet& b) {
+            return combine(a, b, AND_NOT);
+        }
+
+        bool operator==(const RoaringSet& other) const {
+            return size() == other.size() && equal(begin(), end(), other.begin());
+        }
+
+        bool operator!=(const RoaringSet& other) const {
+            return !(*this == other);
+        }
+    };
+} // namespace rpqdb
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef RPQDB_SCC_H
+#define RPQDB_SCC_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "rpqdb/CSRGraph.hpp"
+
+namespace rpqdb {
+    using namespace std;
+
+    // Strongly connected components of a CSR graph (iterative Tarjan) and the
+    // condensed DAG between them. Tarjan finishes a component only after every
+    // component reachable from it, so component ids are in reverse topological
+    // order: all successors of component c have ids smaller than c.
+    class Condensation {
+    private:
+        int num_components = 0;
+        vector<int> component;        // dense vertex -> component
+        vector<int> member_offsets;   // component -> range in members
+        vector<int> members;
+        vector<int> dag_offsets;      // component -> range in dag_targets
+        vector<int> dag_targets;      // distinct successor components
+        vector<bool> cyclic;          // component lies on a cycle
+
+    public:
+        explicit Condensation(const CSRGraph& graph) {
+            int n = graph.numVertices();
+            vector<int> index(n, -1), low(n, 0);
+            vector<bool> on_stack(n, false);
+            vector<int> stack;
+            vector<pair<int, int>> calls;   // (vertex, next edge to visit)
+            component.assign(n, -1);
+            int next_index = 0;
+
+            for (int root = 0; root < n; ++root) {
+                if (index[root] != -1) {
+                    continue;
+                }
+                index[root] = low[root] = next_index++;
+                stack.push_back(root);
+                on_stack[root] = true;
+                calls.emplace_back(root, graph.offsets[root]);
+                while (!calls.empty()) {
+                    auto& [v, edge] = calls.back();
+                    if (edge < graph.offsets[v + 1]) {
+                        int w = graph.targets[edge++];
+                        if (index[w] == -1) {
+                            index[w] = low[w] = next_index++;
+                            stack.push_back(w);
+                            on_stack[w] = true;
+                            calls.emplace_back(w, graph.offsets[w]);
+                        } else if (on_stack[w]) {
+                            low[v] = min(low[v], index[w]);
+                        }
+                        continue;
+                    }
+                    int finished = v;
+                    calls.pop_back();
+                    if (low[finished] == index[finished]) {
+                        int w;
+                        do {
+                            w = stack.back();
+                            stack.pop_back();
+                            on_stack[w] = false;
+                            component[w] = num_components;
+                        } while (w != finished);
+                        num_components++;
+                    }
+                    if (!calls.empty()) {
+                        int parent = calls.back().first;
+                        low[parent] = min(low[parent], low[finished]);
+                    }
+                }
+            }
+
+            member_offsets.assign(num_components + 1, 0);
+            for (int v = 0; v < n; ++v) {
+                member_offsets[component[v] + 1]++;
+            }
+            for (int c = 0; c < num_components; ++c) {
+                member_offsets[c + 1] += member_offsets[c];
+            }
+            members.resize(n);
+            vector<int> fill(member_offsets.begin(), member_offsets.end() - 1);
+            for (int v = 0; v < n; ++v) {
+                members[fill[component[v]]++] = v;
+            }
+
+            cyclic.assign(num_components, false);
+            for (int c = 0; c < num_components; ++c) {
+                cyclic[c] = componentSize(c) > 1;
+            }
+            vector<pair<int, int>> dag_edges;
+            for (int v = 0; v < n; ++v) {
+                for (int i = graph.offsets[v]; i < graph.offsets[v + 1]; ++i) {
+                    int from = component[v], to = component[graph.targets[i]];
+                    if (from != to) {
+                        dag_edges.emplace_back(from, to);
+                    } else if (graph.targets[i] == v) {
+                        cyclic[from] = true;
+                    }
+                }
+            }
+            sort(dag_edges.begin(), dag_edges.end());
+            dag_edges.erase(unique(dag_edges.begin(), dag_edges.end()), dag_edges.end());
+            dag_offsets.assign(num_components + 1, 0);
+            dag_targets.reserve(dag_edges.size());
+            for (const auto& [from, to] : dag_edges) {
+                dag_offsets[from + 1]++;
+                dag_targets.push_back(to);
+            }
+            for (int c = 0; c < num_components; ++c) {
+                dag_offsets[c + 1] += dag_offsets[c];
+            }
+        }
+
+        int numComponents() const {
+            return num_components;
+        }
+
+        int componentOf(int dense_vertex) const {
+            return component[dense_vertex];
+        }
+
+        int componentSize(int c) const {
+            return member_offsets[c + 1] - member_offsets[c];
+        }
+
+        // More than one vertex, or a self-loop: members reach each other (and
+        // themselves) by one or more edges
+        bool isCyclic(int c) const {
+            return cyclic[c];
+        }
+
+        // f(dense vertex) for every vertex of component c
+        template<typename F>
+        void forEachMember(int c, F&& f) const {
+            for (int i = member_offsets[c]; i < member_offsets[c + 1]; ++i) {
+                f(members[i]);
+            }
+        }
+
+        // f(component) for every component with an edge from c
+        template<typename F>
+        void forEachSuccessor(int c, F&& f) const {
+            for (int i = dag_offsets[c]; i < dag_offsets[c + 1]; ++i) {
+                f(dag_targets[i]);
+            }
+        }
+
+        // For every component, the sorted marked vertices reachable from it by
+        // zero or more edges. All members of a component share this set, so it
+        // is computed once per component from the sets of its successors.
+        vector<vector<int>> reachableMarked(const vector<bool>& marked) const {
+            vector<vector<int>> reach(num_components);
+            for (int c = 0; c < num_components; ++c) {
+                vector<int>& rc = reach[c];
+                forEachMember(c, [&](int v) {
+                    if (marked[v]) {
+                        rc.push_back(v);
+                    }
+                });
+                forEachSuccessor(c, [&](int d) {
+                    rc.insert(rc.end(), reach[d].begin(), reach[d].end());
+                });
+                sort(rc.begin(), rc.end());
+                rc.erase(unique(rc.begin(), rc.end()), rc.end());
+            }
+            return reach;
+        }
+    };
+} // namespace rpqdb
+
+#endif
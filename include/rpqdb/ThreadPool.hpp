@@ -0,0 +1,118 @@
+#ifndef RPQDB_ThreadPool_H
+#define RPQDB_ThreadPool_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace rpqdb {
+    using namespace std;
+
+    // Fixed set of worker threads that run one job at a time. A job is either
+    // a loop over [0, n) handed out in small chunks from a shared counter, so
+    // idle workers keep taking work from the busy ones' remaining range, or a
+    // function called once per worker (for statically partitioned work).
+    // Worker ids passed to jobs are 0..size()-1; the calling thread takes part
+    // as worker 0.
+    class ThreadPool {
+    private:
+        vector<thread> workers;
+        mutex mtx;
+        condition_variable job_ready;
+        condition_variable job_done;
+        function<void(int)> job;
+        size_t generation = 0;
+        int running = 0;
+        bool stopping = false;
+
+        void workerLoop(int id) {
+            size_t seen = 0;
+            while (true) {
+                function<void(int)> current;
+                {
+                    unique_lock<mutex> lock(mtx);
+                    job_ready.wait(lock, [&]() { return stopping || generation != seen; });
+                    if (stopping) {
+                        return;
+                    }
+                    seen = generation;
+                    current = job;
+                }
+                current(id);
+                {
+                    lock_guard<mutex> lock(mtx);
+                    if (--running == 0) {
+                        job_done.notify_one();
+                    }
+                }
+            }
+        }
+
+    public:
+        // threads <= 0 uses all hardware threads
+        explicit ThreadPool(int threads = 0) {
+            if (threads <= 0) {
+                threads = max(1u, thread::hardware_concurrency());
+            }
+            for (int id = 1; id < threads; ++id) {
+                workers.emplace_back(&ThreadPool::workerLoop, this, id);
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool() {
+            {
+                lock_guard<mutex> lock(mtx);
+                stopping = true;
+            }
+            job_ready.notify_all();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        int size() const {
+            return workers.size() + 1;
+        }
+
+        // f(worker) on every worker; returns when all calls have finished
+        void runOnAll(const function<void(int)>& f) {
+            {
+                lock_guard<mutex> lock(mtx);
+                job = f;
+                running = workers.size();
+                ++generation;
+            }
+            job_ready.notify_all();
+            f(0);
+            unique_lock<mutex> lock(mtx);
+            job_done.wait(lock, [&]() { return running == 0; });
+        }
+
+        // f(i, worker) for every i in [0, n), claimed in chunks of grain
+        void parallelFor(size_t n, size_t grain, const function<void(size_t, int)>& f) {
+            atomic<size_t> next(0);
+            grain = max<size_t>(1, grain);
+            runOnAll([&](int worker) {
+                while (true) {
+                    size_t begin = next.fetch_add(grain);
+                    if (begin >= n) {
+                        return;
+                    }
+                    size_t end = min(n, begin + grain);
+                    for (size_t i = begin; i < end; ++i) {
+                        f(i, worker);
+                    }
+                }
+            });
+        }
+    };
+} // namespace rpqdb
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef RPQDB_TransitiveClosure_H
+#define RPQDB_TransitiveClosure_H
+
+#include <cstdint>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "rpqdb/CSRGraph.hpp"
+#include "rpqdb/SCC.hpp"
+
+namespace rpqdb {
+    using namespace std;
+
+    // Transitive closure (paths of one or more edges) of a CSR graph, stored
+    // as one bitset row per strongly connected component. Components come in
+    // reverse topological order, so row c only needs bits for components
+    // below c (rows form a triangle) and is filled by OR-ing the rows of its
+    // successors, which are already complete.
+    class BitsetClosure {
+    private:
+        Condensation condensation;
+        vector<size_t> row_offsets;   // component -> first word of its row
+        vector<uint64_t> words;
+
+        static size_t rowWords(int c) {
+            return (size_t(c) + 63) / 64;
+        }
+
+        // to[0, n) |= from[0, n)
+        static void orWords(uint64_t* to, const uint64_t* from, size_t n) {
+            size_t i = 0;
+#if defined(__AVX2__)
+            for (; i + 4 <= n; i += 4) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(to + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), _mm256_or_si256(a, b));
+            }
+#endif
+            for (; i < n; ++i) {
+                to[i] |= from[i];
+            }
+        }
+
+    public:
+        explicit BitsetClosure(const CSRGraph& graph) : condensation(graph) {
+            int k = condensation.numComponents();
+            row_offsets.assign(k + 1, 0);
+            for (int c = 0; c < k; ++c) {
+                row_offsets[c + 1] = row_offsets[c] + rowWords(c);
+            }
+            words.assign(row_offsets[k], 0);
+            for (int c = 0; c < k; ++c) {
+                uint64_t* row = words.data() + row_offsets[c];
+                condensation.forEachSuccessor(c, [&](int d) {
+                    row[d / 64] |= uint64_t(1) << (d % 64);
+                    orWords(row, words.data() + row_offsets[d], rowWords(d));
+                });
+            }
+        }
+
+        const Condensation& components() const {
+            return condensation;
+        }
+
+        // Component c reaches component d != c
+        bool componentReaches(int c, int d) const {
+            return d < c && (words[row_offsets[c] + d / 64] >> (d % 64)) & 1;
+        }
+
+        bool reaches(int dense_from, int dense_to) const {
+            int c = condensation.componentOf(dense_from), d = condensation.componentOf(dense_to);
+            return c == d ? condensation.isCyclic(c) : componentReaches(c, d);
+        }
+
+        // f(dense vertex) for every vertex reachable from dense_from
+        template<typename F>
+        void forEachReachable(int dense_from, F&& f) const {
+            int c = condensation.componentOf(dense_from);
+            if (condensation.isCyclic(c)) {
+                condensation.forEachMember(c, f);
+            }
+            const uint64_t* row = words.data() + row_offsets[c];
+            for (size_t w = 0; w < rowWords(c); ++w) {
+                for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                    condensation.forEachMember(w * 64 + __builtin_ctzll(bits), f);
+                }
+            }
+        }
+    };
+} // namespace rpqdb
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef RPQDB_VisitedSet_H
+#define RPQDB_VisitedSet_H
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+
+namespace rpqdb {
+    using namespace std;
+
+    // Visited marks over dense ids 0..n-1 for repeated traversals. Each slot
+    // stores the epoch in which it was last marked, so clear() only bumps the
+    // current epoch: reset between sources is O(1) instead of reallocating or
+    // rehashing a set.
+    class EpochVisitedSet {
+    private:
+        vector<uint32_t> stamps;
+        uint32_t epoch = 1;
+
+    public:
+        EpochVisitedSet() = default;
+        explicit EpochVisitedSet(size_t n) : stamps(n, 0) {}
+
+        void resize(size_t n) {
+            stamps.assign(n, 0);
+            epoch = 1;
+        }
+
+        size_t capacity() const {
+            return stamps.size();
+        }
+
+        void clear() {
+            if (++epoch == 0) {
+                // wrapped around: old stamps could alias the new epoch
+                fill(stamps.begin(), stamps.end(), 0);
+                epoch = 1;
+            }
+        }
+
+        bool contains(size_t v) const {
+            return stamps[v] == epoch;
+        }
+
+        // Returns true if v was not visited yet
+        bool insert(size_t v) {
+            if (stamps[v] == epoch) {
+                return false;
+            }
+            stamps[v] = epoch;
+            return true;
+        }
+    };
+
+    // One bit per dense id; 32x smaller than EpochVisitedSet, for the large
+    // id spaces of lazy product vertices. clear() only resets the words
+    // marked since the last clear(), so repeated traversals that each touch
+    // a small part of the id space do not pay for the whole bitmap.
+    class BitmapVisitedSet {
+    private:
+        vector<uint64_t> words;
+        vector<size_t> dirty;   // words with a bit set
+
+    public:
+        BitmapVisitedSet() = default;
+        explicit BitmapVisitedSet(size_t n) : words((n + 63) / 64, 0) {}
+
+        void resize(size_t n) {
+            words.assign((n + 63) / 64, 0);
+            dirty.clear();
+        }
+
+        void clear() {
+            for (size_t w : dirty) {
+                words[w] = 0;
+            }
+            dirty.clear();
+        }
+
+        bool contains(size_t v) const {
+            return (words[v / 64] >> (v % 64)) & 1;
+        }
+
+        // Returns true if v was not visited yet
+        bool insert(size_t v) {
+            uint64_t& word = words[v / 64];
+            uint64_t bit = uint64_t(1) << (v % 64);
+            if (word & bit) {
+                return false;
+            }
+            if (word == 0) {
+                dirty.push_back(v / 64);
+            }
+            word |= bit;
+            return true;
+        }
+    };
+
+    // Visited marks in a hash set, for a few traversals in an id space too
+    // large to allocate per call: memory follows the ids inserted, not n.
+    class SparseVisitedSet {
+    private:
+        unordered_set<size_t> marked;
+
+    public:
+        SparseVisitedSet() = default;
+        explicit SparseVisitedSet(size_t) {}
+
+        void clear() {
+            marked.clear();
+        }
+
+        bool contains(size_t v) const {
+            return marked.count(v) > 0;
+        }
+
+        // Returns true if v was not visited yet
+        bool insert(size_t v) {
+            return marked.insert(v).second;
+        }
+    };
+} // namespace rpqdb
+
+#endif
@@ -1,9 +1,19 @@
 #include "unordered_map"
 #include "unordered_set"
 #include <cmath>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <variant>
 #include "rpqdb/Graph.hpp"
 #include "rpqdb/NFA.hpp"
 #include "rpqdb/Profiler.hpp"
+#include "rpqdb/ProductView.hpp"
+#include "rpqdb/RegexProgram.hpp"
+#include "rpqdb/SCC.hpp"
+#include "rpqdb/ThreadPool.hpp"
+#include "rpqdb/TransitiveClosure.hpp"
+#include "rpqdb/VisitedSet.hpp"
 #include <iterator>
 // #define DEBUG
 #include <boost/container/flat_set.hpp>
@@ -69,13 +79,9 @@ namespace rpqdb {
         unordered_map<int, boost::container::flat_set<int>> Eb_reverse; // fast lookup on the second column of Eb
         if (!delta_R_prev.empty()) {
             // All other edges correspond to edges with label b
-            for (const auto& [src, edges] : product.adjList) {
-                // unordered_set<int> dst_set;
-                for (const Edge& e : edges) {
-                    // dst_set.insert(e.dest); 
-                    Eb_reverse[e.dest].insert(src);
-                }
-            }
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].insert(src);
+            });
         }
         END_LOCAL();
 
@@ -162,13 +168,452 @@ namespace rpqdb {
         return VectorReachablePairs(T);
     }
 
-    ReachablePairs<std::unordered_set<int>> OSPG(Graph&& product) {
-        // A bound for heavy/light partition of R
-        // int bound = int(0.2*std::floor(std::sqrt(product.getEdges())))+1;
+    // PG(std::move(product)) under a LIMIT. Every row of R is capped at the
+    // per-source limit k: a row that hits the cap holds k true answers, and a
+    // row below it took complete rows from all its successors, so capped rows
+    // are exactly what a LIMIT needs and the fixpoint never grows a row past
+    // k. The iteration also stops as soon as the starting rows hold
+    // limit.total pairs, since values in a row are final once derived.
+    VectorReachablePairs PG(Graph&& product, const QueryLimit& limit) {
+        typedef boost::container::flat_set<int> Row;
+        size_t per_source = min(limit.per_source, limit.total);
+        unordered_map<int, Row> R_prev;
+        unordered_map<int, Row> delta_R_prev;
+        unordered_map<int, vector<int>> Eb_reverse;
+        size_t answers = 0;
+        if (per_source == 0) {
+            return VectorReachablePairs();
+        }
+
+        START_LOCAL("PG semi-naive limit (delta_R0, R0, Eb_reverse)");
+        for (const auto& vertex : product.accepting_vertices) {
+            delta_R_prev[vertex] = {vertex};
+            answers += product.starting_vertices.count(vertex);
+        }
+        R_prev = delta_R_prev;
+        if (!delta_R_prev.empty()) {
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].push_back(src);
+            });
+        }
+        END_LOCAL();
+
+        START_LOCAL("PG semi-naive limit (R)");
+        vector<int> fresh;
+        while (!delta_R_prev.empty() && answers < limit.total) {
+            unordered_map<int, Row> delta_R;
+            for (const auto& [y, zs] : delta_R_prev) {
+                auto search = Eb_reverse.find(y);
+                if (search == Eb_reverse.end()) {
+                    continue;
+                }
+                for (int x : search->second) {
+                    Row& rx = R_prev[x];
+                    if (rx.size() >= per_source) {
+                        continue;
+                    }
+                    fresh.clear();
+                    set_difference(zs.begin(), zs.end(), rx.begin(), rx.end(), back_inserter(fresh));
+                    fresh.resize(min(fresh.size(), per_source - rx.size()));
+                    if (!fresh.empty()) {
+                        rx.insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                        delta_R[x].insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                        if (product.starting_vertices.count(x)) {
+                            answers += fresh.size();
+                        }
+                    }
+                }
+            }
+            delta_R_prev = std::move(delta_R);
+        }
+        END_LOCAL();
+
+        START_LOCAL("PG semi-naive limit (T)");
+        unordered_map<int, Row> T;
+        size_t total = 0;
+        for (int x : product.starting_vertices) {
+            auto search = R_prev.find(x);
+            if (search == R_prev.end() || total == limit.total) {
+                continue;
+            }
+            Row& tx = T[x];
+            size_t take = min(search->second.size(), limit.total - total);
+            tx.insert(boost::container::ordered_unique_range, search->second.begin(), search->second.begin() + take);
+            total += take;
+        }
+        END_LOCAL();
+        return VectorReachablePairs(T);
+    }
+
+    // Thread owning vertex x in the partitioned evaluators (multiplicative
+    // hash, so consecutive ids spread over all parts)
+    inline int partitionOf(int x, int parts) {
+        return (uint64_t(uint32_t(x) * 2654435761u) * parts) >> 32;
+    }
+
+    // PG(Graph&&) with the semi-naive fixpoint spread over a thread pool.
+    // Tuples R(X, Z) are hash-partitioned by X: each thread owns the slice of
+    // R and delta R for its X. An iteration has two phases separated by a
+    // barrier:
+    //  - join: each thread joins its delta R^{i-1}(Y, Z) with Eb(X, b, Y) and
+    //    sends (X, Z-set) to the owner of X
+    //  - merge: each thread removes R^{i-1}(X, Z) from what it received and
+    //    adds the rest to its R and delta R^i
+    // Same answers as PG(Graph&&); threads <= 0 uses all hardware threads.
+    VectorReachablePairs PG_Parallel(Graph&& product, int threads = 0) {
+        typedef boost::container::flat_set<int> Row;
+        ThreadPool pool(threads);
+        int parts = pool.size();
+
+        vector<unordered_map<int, Row>> R(parts);
+        vector<unordered_map<int, Row>> delta_R_prev(parts);
+        // inbox[owner][sender]: rows of delta R^{i-1} to join into the owner's R
+        vector<vector<vector<pair<int, const Row*>>>> inbox(parts, vector<vector<pair<int, const Row*>>>(parts));
+        unordered_map<int, vector<int>> Eb_reverse;
+        unordered_map<int, Row> T;
+
+        START_LOCAL("PG parallel (delta_R0, R0, Eb_reverse)");
+        for (const auto& vertex : product.accepting_vertices) {
+            int owner = partitionOf(vertex, parts);
+            delta_R_prev[owner][vertex] = {vertex};
+            R[owner][vertex] = {vertex};
+        }
+        if (!product.accepting_vertices.empty()) {
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].push_back(src);
+            });
+        }
+        END_LOCAL();
+
+        START_LOCAL("PG parallel (R)");
+        bool changed = !product.accepting_vertices.empty();
+        while (changed) {
+            pool.runOnAll([&](int worker) {
+                for (int owner = 0; owner < parts; ++owner) {
+                    inbox[owner][worker].clear();
+                }
+                for (const auto& [y, zs] : delta_R_prev[worker]) {
+                    auto search = Eb_reverse.find(y);
+                    if (search == Eb_reverse.end()) {
+                        continue;
+                    }
+                    for (int x : search->second) {
+                        inbox[partitionOf(x, parts)][worker].emplace_back(x, &zs);
+                    }
+                }
+            });
+
+            vector<unordered_map<int, Row>> delta_R(parts);
+            pool.runOnAll([&](int worker) {
+                auto& r = R[worker];
+                auto& delta = delta_R[worker];
+                vector<int> fresh;
+                for (int sender = 0; sender < parts; ++sender) {
+                    // the join phase of every sender has finished writing here
+                    for (const auto& [x, zs] : inbox[worker][sender]) {
+                        Row& rx = r[x];
+                        fresh.clear();
+                        set_difference(zs->begin(), zs->end(), rx.begin(), rx.end(), back_inserter(fresh));
+                        if (!fresh.empty()) {
+                            rx.insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                            delta[x].insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                        }
+                    }
+                }
+            });
+
+            changed = false;
+            for (int part = 0; part < parts; ++part) {
+                changed = changed || !delta_R[part].empty();
+            }
+            delta_R_prev = std::move(delta_R);
+        }
+        END_LOCAL();
+
+        START_LOCAL("PG parallel (T)");
+        // T(X, Z) = Ea(X, a, X), R(X, Z)
+        for (const auto& x : product.starting_vertices) {
+            auto& r = R[partitionOf(x, parts)];
+            auto search = r.find(x);
+            if (search != r.end()) {
+                T[x] = std::move(search->second);
+            }
+        }
+        END_LOCAL();
+        return VectorReachablePairs(T);
+    }
+
+    // Reach of a few sampled starting vertices of a product graph, from BFS
+    struct ReachSample {
+        size_t starting = 0;        // starting vertices in the product
+        size_t accepting = 0;       // accepting vertices in the product
+        vector<size_t> reached;     // accepting vertices reached (zero or more edges) per sample
+        vector<size_t> work;        // edges scanned per sample
+        vector<bool> truncated;     // ran out of edge budget: reached is a lower bound
+    };
+
+    // BFS from each of starts (ids below id_space), scanning at most
+    // edge_budget edges each, appended to sample. is_accepting(v) and
+    // for_each_successor(v, f) describe the product.
+    template<typename Vertex, typename IsAccepting, typename ForEachSuccessor>
+    void sampleTraversals(const vector<Vertex>& starts, size_t id_space, size_t edge_budget,
+                          IsAccepting&& is_accepting, ForEachSuccessor&& for_each_successor, ReachSample& sample) {
+        BitmapVisitedSet visited(id_space);
+        vector<Vertex> q;
+        for (Vertex start : starts) {
+            size_t reached = 0, work = 0;
+            bool truncated = false;
+            visited.clear();
+            visited.insert(start);
+            q.assign(1, start);
+            for (size_t head = 0; head < q.size() && !truncated; ++head) {
+                Vertex z = q[head];
+                reached += is_accepting(z);
+                for_each_successor(z, [&](Vertex y) {
+                    if (truncated || ++work > edge_budget) {
+                        truncated = true;
+                        return;
+                    }
+                    if (visited.insert(y)) {
+                        q.push_back(y);
+                    }
+                });
+            }
+            sample.reached.push_back(reached);
+            sample.work.push_back(min(work, edge_budget));
+            sample.truncated.push_back(truncated);
+        }
+    }
+
+    // Up to samples elements of values picked at random (fixed seed)
+    template<typename T>
+    vector<T> pickSample(vector<T> values, size_t samples, unsigned seed) {
+        if (values.size() > samples) {
+            mt19937 rng(seed);
+            shuffle(values.begin(), values.end(), rng);
+            values.resize(samples);
+        }
+        return values;
+    }
+
+    // BFS over graph from up to samples vertices of from picked at random
+    // (fixed seed), each scanning at most edge_budget edges and counting the
+    // vertices of to it reaches
+    ReachSample sampleReach(const CSRGraph& graph, const unordered_set<int>& from, const unordered_set<int>& to,
+                            size_t samples, size_t edge_budget, unsigned seed) {
+        ReachSample sample;
+        sample.starting = from.size();
+        sample.accepting = to.size();
+        if (sample.starting == 0) {
+            return sample;
+        }
+        vector<char> is_accepting(graph.numVertices(), 0);
+        for (int v : to) {
+            int dense = graph.denseId(v);
+            if (dense >= 0) {
+                is_accepting[dense] = 1;
+            }
+        }
+
+        vector<int> starts(from.begin(), from.end());
+        sort(starts.begin(), starts.end());
+        vector<int> dense_starts;
+        for (int start : pickSample(std::move(starts), samples, seed)) {
+            int dense = graph.denseId(start);
+            if (dense >= 0) {
+                dense_starts.push_back(dense);
+            } else {
+                // isolated vertex
+                sample.reached.push_back(to.count(start));
+                sample.work.push_back(0);
+                sample.truncated.push_back(false);
+            }
+        }
+        sampleTraversals(dense_starts, graph.numVertices(), edge_budget,
+            [&](int v) { return is_accepting[v]; },
+            [&](int v, auto&& f) {
+                for (int e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                    f(graph.targets[e]);
+                }
+            }, sample);
+        return sample;
+    }
+
+    // BFS from up to samples starting vertices picked at random (fixed seed),
+    // each scanning at most edge_budget edges
+    ReachSample sampleReach(Graph& product, size_t samples, size_t edge_budget, unsigned seed = 1) {
+        return sampleReach(*product.denseView(), product.starting_vertices, product.accepting_vertices,
+                           samples, edge_budget, seed);
+    }
+
+    // sampleReach() in the other direction, as traversed by
+    // Graph::PG_Backward(): from accepting vertices over in-edges, counting
+    // starting vertices. starting and accepting of the sample are swapped.
+    ReachSample sampleReachBackward(Graph& product, size_t samples, size_t edge_budget, unsigned seed = 1) {
+        return sampleReach(*product.reverseDenseView(), product.accepting_vertices, product.starting_vertices,
+                           samples, edge_budget, seed);
+    }
+
+    // sampleReach() on the lazy product of graph and dfa: starting vertices are
+    // (start state, v) for every data vertex v
+    ReachSample sampleReach(const ProductView& product, size_t samples, size_t edge_budget, unsigned seed = 1) {
+        int n = product.numDataVertices();
+        ReachSample sample;
+        sample.starting = n;
+        for (int q = 0; q < product.numStates(); ++q) {
+            if (product.isAcceptingState(q) && (q == product.startState() || product.hasIncomingTransitions(q))) {
+                sample.accepting += n;
+            }
+        }
+        vector<ProductVertex> starts(n);
+        for (int v = 0; v < n; ++v) {
+            starts[v] = product.encode(product.startState(), v);
+        }
+        sampleTraversals(pickSample(std::move(starts), samples, seed), size_t(product.numStates()) * n, edge_budget,
+            [&](ProductVertex p) { return product.isAccepting(p); },
+            [&](ProductVertex p, auto&& f) { product.forEachSuccessor(p, f); }, sample);
+        return sample;
+    }
+
+    ReachSample sampleReach(Graph& graph, NFA& dfa, size_t samples, size_t edge_budget, unsigned seed = 1) {
+        graph.seal();
+        return sampleReach(ProductView(graph.getCSR(), graph.getReverseCSR(), dfa), samples, edge_budget, seed);
+    }
+
+    // Estimated number of reachable pairs (as counted by PG(Graph&&)), with a
+    // confidence interval
+    struct OutputEstimate {
+        double pairs = 0;
+        double low = 0;
+        double high = 0;
+        size_t samples = 0;
+        size_t truncated = 0;       // samples cut short by the edge budget
+    };
+
+    // Scales the mean sampled reach to all starting vertices. The interval is
+    // mean +- z standard errors (with finite population correction, so it
+    // closes when every starting vertex was sampled); for a sample cut short
+    // its reach counts as is for the low end and as every accepting vertex for
+    // the high end.
+    OutputEstimate estimateOutputSize(const ReachSample& sample, double z = 1.96) {
+        OutputEstimate estimate;
+        size_t k = sample.reached.size();
+        estimate.samples = k;
+        if (k == 0) {
+            return estimate;
+        }
+        auto mean_and_error = [&](bool optimistic) {
+            double sum = 0, sum_squares = 0;
+            for (size_t i = 0; i < k; ++i) {
+                double r = optimistic && sample.truncated[i] ? double(sample.accepting) : double(sample.reached[i]);
+                sum += r;
+                sum_squares += r * r;
+            }
+            double mean = sum / k;
+            double variance = k > 1 ? max(0.0, (sum_squares - k * mean * mean) / (k - 1)) : 0;
+            double correction = sample.starting > 1 ? double(sample.starting - k) / (sample.starting - 1) : 0;
+            return make_pair(mean, std::sqrt(variance / k * max(0.0, correction)));
+        };
+        estimate.truncated = count(sample.truncated.begin(), sample.truncated.end(), true);
+        auto [mean_low, error_low] = mean_and_error(false);
+        auto [mean_high, error_high] = mean_and_error(true);
+        double total = double(sample.starting);
+        double max_pairs = total * sample.accepting;
+        estimate.pairs = min(max_pairs, (mean_low + mean_high) / 2 * total);
+        estimate.low = max(0.0, (mean_low - z * error_low) * total);
+        estimate.high = min(max_pairs, (mean_high + z * error_high) * total);
+        return estimate;
+    }
+
+    // Samples up to samples starting vertices, with at most 4|E| edges scanned
+    // in total unless edge_budget (per sample) is given
+    OutputEstimate estimateOutputSize(Graph& product, size_t samples = 64, size_t edge_budget = 0, double z = 1.96) {
+        START_LOCAL("Estimate output size");
+        if (edge_budget == 0) {
+            edge_budget = max<size_t>(64, 4 * size_t(product.getEdges()) / samples);
+        }
+        OutputEstimate estimate = estimateOutputSize(sampleReach(product, samples, edge_budget), z);
+        END_LOCAL();
+        return estimate;
+    }
+
+    // Same on the lazy product of graph and dfa; the budget is relative to the
+    // data graph
+    OutputEstimate estimateOutputSize(Graph& graph, NFA& dfa, size_t samples = 64, size_t edge_budget = 0, double z = 1.96) {
+        START_LOCAL("Estimate output size on-the-fly");
+        graph.seal();
+        if (edge_budget == 0) {
+            edge_budget = max<size_t>(64, 4 * size_t(graph.getEdges()) / samples);
+        }
+        OutputEstimate estimate = estimateOutputSize(sampleReach(graph, dfa, samples, edge_budget), z);
+        END_LOCAL();
+        return estimate;
+    }
+
+    // Estimated work of OSPG with a given bound, from a sample of |R(X, .)|
+    // for starting X:
+    //   light cost  |E| * avg(min(|R(X, .)|, bound))     (tuples pushed per edge)
+    // + heavy cost  |Ea| * avg(work of X, |R(X, .)| >= bound)   (forward traversals)
+    double estimateOSPGCost(const ReachSample& sample, size_t edges, size_t bound) {
+        if (sample.reached.empty()) {
+            return 0;
+        }
+        double light = 0, heavy = 0;
+        for (size_t i = 0; i < sample.reached.size(); ++i) {
+            size_t r = sample.reached[i];
+            light += min(r, bound);
+            if (r >= bound || sample.truncated[i]) {
+                heavy += sample.work[i];
+            }
+        }
+        return (double(edges) * light + double(sample.starting) * heavy) / sample.reached.size();
+    }
 
-        int bound = std::floor(std::sqrt(product.getEdges()))+1;
-        // int bound = 5;
-        cout << "Degree bound is "<< bound << endl;
+    // Bound with the lowest estimateOSPGCost() among the bounds at which a
+    // sampled X changes sides and sqrt(|E|) + 1, which is also the fallback
+    // without samples
+    int bestOSPGBound(const ReachSample& sample, size_t edges) {
+        int bound = std::floor(std::sqrt(edges))+1;
+        vector<size_t> candidates = {2, size_t(bound)};
+        for (size_t r : sample.reached) {
+            candidates.push_back(r + 1);
+        }
+        double best_cost = -1;
+        for (size_t candidate : candidates) {
+            double cost = estimateOSPGCost(sample, edges, candidate);
+            if (best_cost < 0 || cost < best_cost) {
+                best_cost = cost;
+                bound = candidate;
+            }
+        }
+        return bound;
+    }
+
+    // Heavy/light degree bound for the OSPG evaluators, recorded as a stat. A
+    // positive bound is used as given; otherwise bestOSPGBound() on
+    // sample(samples, edge_budget), a ReachSample of starting vertices
+    // scanning at most 2|E| edges in total.
+    template<typename Sampler>
+    int chooseOSPGBound(size_t edges, int bound, Sampler&& sample) {
+        if (bound <= 0) {
+            START_LOCAL("OSPG bound selection");
+            const size_t samples = 16;
+            bound = bestOSPGBound(sample(samples, max<size_t>(64, 2 * edges / samples)), edges);
+            END_LOCAL();
+        }
+        RECORD_STAT("OSPG bound", bound);
+        return bound;
+    }
+
+    int chooseOSPGBound(Graph& product, int bound = 0) {
+        return chooseOSPGBound(product.getEdges(), bound, [&](size_t samples, size_t edge_budget) {
+            return sampleReach(product, samples, edge_budget);
+        });
+    }
+
+    ReachablePairs<std::unordered_set<int>> OSPG(Graph&& product, int bound_override = 0) {
+        // A bound for heavy/light partition of R
+        int bound = chooseOSPGBound(product, bound_override);
 
         unordered_set<int> Ea;
         unordered_map<int, unordered_set<int>> Eb_reverse; // fast lookup on the second column of Eb
@@ -220,11 +665,9 @@ namespace rpqdb {
         // Build Eb_reverse jit
         if (!delta_R_prev.empty()) {
             // All other edges correspond to edges with label b
-            for (const auto& [src, edges] : product.adjList) {
-                for (const Edge& e : edges) {
-                    Eb_reverse[e.dest].insert(src);
-                }
-            }
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].insert(src);
+            });
         }
         END_LOCAL();
 
@@ -314,6 +757,8 @@ namespace rpqdb {
                 R_light[x] = R[x];
             }
         }
+        RECORD_STAT("OSPG heavy", R_heavy.size());
+        RECORD_STAT("OSPG light", R_light.size());
         END_LOCAL();
 
         #ifdef DEBUG
@@ -365,13 +810,9 @@ namespace rpqdb {
 
         // Build Eb only if delta_T_prev is greater than 0
         if (!delta_T_prev.empty()) {
-            for (const auto& [src, edges] : product.adjList) {
-                // unordered_set<int> dst_set;
-                for (const Edge& e : edges) {
-                    // dst_set.insert(e.dest); 
-                    Eb[src].insert(e.dest);
-                }
-            }
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb[src].insert(dest);
+            });
         }
         END_LOCAL();
 
@@ -432,6 +873,379 @@ namespace rpqdb {
         return Q_light;
     }
 
+    // OSPG(Graph&&) on a thread pool, partitioned by X like PG_Parallel():
+    //  - the degree-bounded R fixpoint runs in join/merge phases; the owner of
+    //    X is the only thread touching R(X, .), so the degree of X (the size of
+    //    its row) stays exact without locks
+    //  - each owner splits its X into Rl/Rh and computes Ql for its light X
+    //  - the heavy starting X are traversed forward over Eb in parallel, each
+    //    worker with its own visited set, and give Qh
+    //  - Ql + Qh are merged per partition
+    // Same answers as OSPG(Graph&&); threads <= 0 uses all hardware threads.
+    VectorReachablePairs OSPG_Parallel(Graph&& product, int threads = 0, int bound_override = 0) {
+        typedef boost::container::flat_set<int> Row;
+        // A bound for heavy/light partition of R
+        size_t bound = chooseOSPGBound(product, bound_override);
+
+        ThreadPool pool(threads);
+        int parts = pool.size();
+
+        vector<unordered_map<int, Row>> R(parts);
+        vector<unordered_map<int, Row>> delta_R_prev(parts);
+        vector<vector<vector<pair<int, const Row*>>>> inbox(parts, vector<vector<pair<int, const Row*>>>(parts));
+        unordered_map<int, vector<int>> Eb_reverse;
+        vector<unordered_map<int, Row>> Q(parts);
+
+        START_LOCAL("OSPG parallel (delta_R0, R0, Eb_reverse)");
+        for (const auto& vertex : product.accepting_vertices) {
+            int owner = partitionOf(vertex, parts);
+            delta_R_prev[owner][vertex] = {vertex};
+            R[owner][vertex] = {vertex};
+        }
+        if (!product.accepting_vertices.empty()) {
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].push_back(src);
+            });
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG parallel (R)");
+        // Compute R(X, Y) satisfying degree(X) < bound
+        bool changed = !product.accepting_vertices.empty();
+        while (changed) {
+            pool.runOnAll([&](int worker) {
+                for (int owner = 0; owner < parts; ++owner) {
+                    inbox[owner][worker].clear();
+                }
+                for (const auto& [y, zs] : delta_R_prev[worker]) {
+                    auto search = Eb_reverse.find(y);
+                    if (search == Eb_reverse.end()) {
+                        continue;
+                    }
+                    for (int x : search->second) {
+                        inbox[partitionOf(x, parts)][worker].emplace_back(x, &zs);
+                    }
+                }
+            });
+
+            vector<unordered_map<int, Row>> delta_R(parts);
+            pool.runOnAll([&](int worker) {
+                auto& r = R[worker];
+                auto& delta = delta_R[worker];
+                vector<int> fresh;
+                for (int sender = 0; sender < parts; ++sender) {
+                    for (const auto& [x, zs] : inbox[worker][sender]) {
+                        Row& rx = r[x];
+                        if (rx.size() >= bound) {
+                            continue;
+                        }
+                        fresh.clear();
+                        set_difference(zs->begin(), zs->end(), rx.begin(), rx.end(), back_inserter(fresh));
+                        fresh.resize(min(fresh.size(), bound - rx.size()));
+                        if (!fresh.empty()) {
+                            rx.insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                            delta[x].insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                        }
+                    }
+                }
+            });
+
+            changed = false;
+            for (int part = 0; part < parts; ++part) {
+                changed = changed || !delta_R[part].empty();
+            }
+            delta_R_prev = std::move(delta_R);
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG parallel (Rl, Rh, Ql)");
+        // Ql(X, Y) :- Rl(X, Y), Ea(X, X).
+        vector<vector<int>> heavy(parts);
+        vector<size_t> heavy_count(parts, 0);
+        pool.runOnAll([&](int worker) {
+            for (auto& [x, ys] : R[worker]) {
+                heavy_count[worker] += ys.size() >= bound;
+                if (!product.starting_vertices.count(x)) {
+                    continue;
+                }
+                if (ys.size() >= bound) {
+                    heavy[worker].push_back(x);
+                } else {
+                    Q[worker][x] = std::move(ys);
+                }
+            }
+        });
+        size_t total_heavy = 0, total_rows = 0;
+        for (int part = 0; part < parts; ++part) {
+            total_heavy += heavy_count[part];
+            total_rows += R[part].size();
+            R[part].clear();
+        }
+        RECORD_STAT("OSPG heavy", total_heavy);
+        RECORD_STAT("OSPG light", total_rows - total_heavy);
+        END_LOCAL();
+
+        START_LOCAL("OSPG parallel (Qh)");
+        // T(X, Y) by forward traversal from every heavy starting X, then T o Ec
+        vector<int> heavy_starts;
+        for (const auto& part : heavy) {
+            heavy_starts.insert(heavy_starts.end(), part.begin(), part.end());
+        }
+        vector<Row> Q_heavy(heavy_starts.size());
+        if (!heavy_starts.empty()) {
+            shared_ptr<const CSRGraph> graph = product.denseView();
+            int n = graph->numVertices();
+            vector<char> is_accepting(n, 0);
+            for (int v : product.accepting_vertices) {
+                int dense = graph->denseId(v);
+                if (dense >= 0) {
+                    is_accepting[dense] = 1;
+                }
+            }
+            vector<EpochVisitedSet> visited(parts);
+            vector<vector<int>> queues(parts);
+            pool.parallelFor(heavy_starts.size(), 1, [&](size_t i, int worker) {
+                EpochVisitedSet& seen = visited[worker];
+                vector<int>& q = queues[worker];
+                if (seen.capacity() != size_t(n)) {
+                    seen.resize(n);
+                }
+                int start = graph->denseId(heavy_starts[i]);
+                if (start < 0) {
+                    // isolated vertex: only the empty path
+                    if (product.accepting_vertices.count(heavy_starts[i])) {
+                        Q_heavy[i] = Row{heavy_starts[i]};
+                    }
+                    return;
+                }
+                seen.clear();
+                vector<int> found;
+                seen.insert(start);
+                q.assign(1, start);
+                for (size_t head = 0; head < q.size(); ++head) {
+                    int z = q[head];
+                    if (is_accepting[z]) {
+                        found.push_back(graph->originalId(z));
+                    }
+                    for (int e = graph->offsets[z]; e < graph->offsets[z + 1]; ++e) {
+                        if (seen.insert(graph->targets[e])) {
+                            q.push_back(graph->targets[e]);
+                        }
+                    }
+                }
+                Q_heavy[i] = Row(found.begin(), found.end());
+            });
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG parallel (Ql + Qh)");
+        unordered_map<int, Row> result;
+        size_t offset = 0;
+        for (int part = 0; part < parts; ++part) {
+            for (int x : heavy[part]) {
+                Q[part][x] = std::move(Q_heavy[offset++]);
+            }
+            if (result.empty()) {
+                result = std::move(Q[part]);
+            } else {
+                for (auto& [x, ys] : Q[part]) {
+                    result[x] = std::move(ys);
+                }
+            }
+        }
+        END_LOCAL();
+        return VectorReachablePairs(result);
+    }
+
+    // Count and existence modes: the size of, or whether there is any pair in,
+    // the answer of PG(Graph&&) / OSPG(Graph&&), without materializing it.
+
+    // PG(std::move(product)).size(): the pairs of Graph::PG_Count() (counted
+    // by popcount) plus the starting vertices that are accepting, which
+    // PG(Graph&&) pairs with themselves
+    size_t PG_Count(Graph&& product) {
+        size_t count = product.PG_Count();
+        for (int x : product.starting_vertices) {
+            count += product.accepting_vertices.count(x);
+        }
+        return count;
+    }
+
+    // PG(std::move(product)).size() > 0, stopping at the first pair: a
+    // starting vertex that is accepting, or else the first accepting vertex
+    // met by one traversal from all starting vertices
+    bool PG_Exists(Graph&& product) {
+        if (product.starting_vertices.empty() || product.accepting_vertices.empty()) {
+            return false;
+        }
+        for (int x : product.starting_vertices) {
+            if (product.accepting_vertices.count(x)) {
+                return true;
+            }
+        }
+        START_LOCAL("PG exists");
+        shared_ptr<const CSRGraph> graph = product.denseView();
+        EpochVisitedSet visited(graph->numVertices());
+        vector<int> q;
+        for (int x : product.starting_vertices) {
+            int dense = graph->denseId(x);
+            if (dense >= 0 && visited.insert(dense)) {
+                q.push_back(dense);
+            }
+        }
+        bool found = false;
+        for (size_t head = 0; head < q.size() && !found; ++head) {
+            int z = q[head];
+            for (int e = graph->offsets[z]; e < graph->offsets[z + 1]; ++e) {
+                int y = graph->targets[e];
+                if (visited.insert(y)) {
+                    if (product.accepting_vertices.count(graph->originalId(y))) {
+                        found = true;
+                        break;
+                    }
+                    q.push_back(y);
+                }
+            }
+        }
+        END_LOCAL();
+        return found;
+    }
+
+    // OSPG(std::move(product)) streamed to emit(x, z) (see emitPair()). The
+    // degree-bounded R fixpoint is kept (rows hold at most bound values); once
+    // it is done, light starting X emit their rows and heavy starting X emit
+    // every accepting vertex of a forward traversal as it is discovered, so T
+    // is never materialized. Under a LIMIT, rows are capped at the per-source
+    // limit as well: a row that hits the cap holds true answers only, and a
+    // row below it is complete, so capped rows answer the LIMIT directly.
+    template<typename Sink>
+    void OSPG_Stream(Graph&& product, Sink&& emit, int bound_override = 0, const QueryLimit& limit = {}) {
+        typedef boost::container::flat_set<int> Row;
+        size_t per_source = min(limit.per_source, limit.total);
+        if (per_source == 0) {
+            return;
+        }
+        size_t bound = chooseOSPGBound(product, bound_override);
+        // rows capped at per_source already hold all a source may report
+        bool rows_suffice = per_source <= bound;
+        bound = min(bound, per_source);
+
+        unordered_map<int, Row> R_prev;
+        unordered_map<int, Row> delta_R_prev;
+        unordered_map<int, vector<int>> Eb_reverse;
+
+        START_LOCAL("OSPG stream (delta_R0, R0, Eb_reverse)");
+        for (const auto& vertex : product.accepting_vertices) {
+            delta_R_prev[vertex] = {vertex};
+        }
+        R_prev = delta_R_prev;
+        if (!delta_R_prev.empty()) {
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].push_back(src);
+            });
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG stream (R)");
+        vector<int> fresh;
+        while (!delta_R_prev.empty()) {
+            unordered_map<int, Row> delta_R;
+            for (const auto& [y, zs] : delta_R_prev) {
+                auto search = Eb_reverse.find(y);
+                if (search == Eb_reverse.end()) {
+                    continue;
+                }
+                for (int x : search->second) {
+                    Row& rx = R_prev[x];
+                    if (rx.size() >= bound) {
+                        continue;
+                    }
+                    fresh.clear();
+                    set_difference(zs.begin(), zs.end(), rx.begin(), rx.end(), back_inserter(fresh));
+                    fresh.resize(min(fresh.size(), bound - rx.size()));
+                    if (!fresh.empty()) {
+                        rx.insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                        delta_R[x].insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                    }
+                }
+            }
+            delta_R_prev = std::move(delta_R);
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG stream (Ql, Qh)");
+        shared_ptr<const CSRGraph> graph;
+        EpochVisitedSet visited;
+        vector<int> q;
+        size_t total = 0;
+        bool more = true;
+        for (auto it = product.starting_vertices.begin(); more && it != product.starting_vertices.end(); ++it) {
+            int x = *it;
+            auto search = R_prev.find(x);
+            if (search == R_prev.end()) {
+                continue;
+            }
+            if (search->second.size() < bound || rows_suffice) {
+                for (auto z = search->second.begin(); more && z != search->second.end(); ++z) {
+                    more = emitPair(emit, x, *z) && ++total < limit.total;
+                }
+                continue;
+            }
+            // heavy: T o Ec by traversal
+            if (!graph) {
+                graph = product.denseView();
+                visited.resize(graph->numVertices());
+            }
+            int start = graph->denseId(x);
+            if (start < 0) {
+                // isolated vertex: only the empty path
+                if (product.accepting_vertices.count(x)) {
+                    more = emitPair(emit, x, x) && ++total < limit.total;
+                }
+                continue;
+            }
+            visited.clear();
+            visited.insert(start);
+            q.assign(1, start);
+            size_t found = 0;
+            for (size_t head = 0; more && found < per_source && head < q.size(); ++head) {
+                int z = q[head];
+                if (product.accepting_vertices.count(graph->originalId(z))) {
+                    found++;
+                    more = emitPair(emit, x, graph->originalId(z)) && ++total < limit.total;
+                }
+                for (int e = graph->offsets[z]; e < graph->offsets[z + 1]; ++e) {
+                    if (visited.insert(graph->targets[e])) {
+                        q.push_back(graph->targets[e]);
+                    }
+                }
+            }
+        }
+        END_LOCAL();
+    }
+
+    // OSPG(std::move(product)) under a LIMIT, collected from OSPG_Stream()
+    UnorderedReachablePairs OSPG(Graph&& product, const QueryLimit& limit, int bound_override = 0) {
+        UnorderedReachablePairs result;
+        OSPG_Stream(std::move(product), [&](int x, int z) {
+            result.addPair(x, z);
+        }, bound_override, limit);
+        return result;
+    }
+
+    // OSPG(std::move(product)).size() from OSPG_Stream() with a counting sink
+    size_t OSPG_Count(Graph&& product, int bound_override = 0) {
+        size_t count = 0;
+        OSPG_Stream(std::move(product), [&](int, int) {
+            count++;
+        }, bound_override);
+        return count;
+    }
+
+    bool OSPG_Exists(Graph&& product) {
+        return PG_Exists(std::move(product));
+    }
+
     NFA query(NFA & data_nfa, const string& pattern) {
         // cout << "Data nfa" << endl;
         // data_nfa.print();
@@ -441,11 +1255,10 @@ namespace rpqdb {
         return query_nfa.product(data_nfa);
     }
 
-    ReachablePairs<std::set<int>> OSPG_OrderedSet(Graph&& product) {
+    ReachablePairs<std::set<int>> OSPG_OrderedSet(Graph&& product, int bound_override = 0) {
         // Represent binary relations as insertion-ordered set
         // A bound for heavy/light partition of R
-        int bound = std::floor(std::sqrt(product.getEdges()))+1;
-        cout << "Degree bound is "<< bound << endl;
+        int bound = chooseOSPGBound(product, bound_override);
     
         // Ea simply looks up, still use unordered set (hash map)
         unordered_set<int> Ea;
@@ -496,11 +1309,9 @@ namespace rpqdb {
         // Build Eb_reverse jit
         if (!delta_R_prev.empty()) {
             // All other edges correspond to edges with label b
-            for (const auto& [src, edges] : product.adjList) {
-                for (const Edge& e : edges) {
-                    Eb_reverse[e.dest].insert(src);
-                }
-            }
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].insert(src);
+            });
         }
         END_LOCAL();
     
@@ -542,6 +1353,8 @@ namespace rpqdb {
                 R_light[x] = R[x];
             }
         }
+        RECORD_STAT("OSPG heavy", R_heavy.size());
+        RECORD_STAT("OSPG light", R_light.size());
         END_LOCAL();
     
         #ifdef DEBUG
@@ -593,13 +1406,9 @@ namespace rpqdb {
     
         // Build Eb only if delta_T_prev is greater than 0
         if (!delta_T_prev.empty()) {
-            for (const auto& [src, edges] : product.adjList) {
-                // unordered_set<int> dst_set;
-                for (const Edge& e : edges) {
-                    // dst_set.insert(e.dest); 
-                    Eb[src].insert(e.dest);
-                }
-            }
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb[src].insert(dest);
+            });
         }
         END_LOCAL();
     
@@ -664,10 +1473,9 @@ namespace rpqdb {
         return ReachablePairs<std::set<int>>(Q_heavy);
     }
     
-    ReachablePairs<boost::container::flat_set<int>> OSPG_OrderedVector(Graph&& product) {
+    ReachablePairs<boost::container::flat_set<int>> OSPG_OrderedVector(Graph&& product, int bound_override = 0) {
         // A bound for heavy/light partition of R
-        int bound = std::floor(std::sqrt(product.getEdges()))+1;
-        cout << "Degree bound is "<< bound << endl;
+        int bound = chooseOSPGBound(product, bound_override);
     
         // Ea simply looks up, still use unordered set (hash map)
         unordered_set<int> Ea;
@@ -715,11 +1523,9 @@ namespace rpqdb {
         // Build Eb_reverse jit
         if (!delta_R_prev.empty()) {
             // All other edges correspond to edges with label b
-            for (const auto& [src, edges] : product.adjList) {
-                for (const Edge& e : edges) {
-                    Eb_reverse[e.dest].push_back(src);
-                }
-            }
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].push_back(src);
+            });
         }
         END_LOCAL();
     
@@ -734,7 +1540,8 @@ namespace rpqdb {
                 
                 for (const auto& x: xs) {
                     if (R_prev.find(x) == R_prev.end()){
-                        auto rhs = boost::container::flat_set<int>(zs.begin(), min(zs.begin()+bound-1, zs.end()));
+                        // keep up to bound values so that a cut row always ends up heavy
+                        auto rhs = boost::container::flat_set<int>(zs.begin(), zs.begin() + min<size_t>(zs.size(), bound));
                         R_prev[x] = rhs;
                         delta_R[x] = rhs;
                     } else {
@@ -760,6 +1567,8 @@ namespace rpqdb {
                 R_light[x] = R[x];
             }
         }
+        RECORD_STAT("OSPG heavy", R_heavy.size());
+        RECORD_STAT("OSPG light", R_light.size());
         END_LOCAL();
     
         #ifdef DEBUG
@@ -811,13 +1620,9 @@ namespace rpqdb {
     
         // Build Eb only if delta_T_prev is greater than 0
         if (!delta_T_prev.empty()) {
-            for (const auto& [src, edges] : product.adjList) {
-                // unordered_set<int> dst_set;
-                for (const Edge& e : edges) {
-                    // dst_set.insert(e.dest); 
-                    Eb[src].insert(e.dest);
-                }
-            }
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb[src].insert(dest);
+            });
         }
         END_LOCAL();
     
@@ -901,6 +1706,895 @@ namespace rpqdb {
         }
     }
 
+    // OSPG with every relation kept as RoaringSet rows. The inner loops work
+    // on whole rows: delta R(X, .) = delta R_prev(Y, .) - R_prev(X, .), cut to
+    // the remaining degree budget of X, and T and Qh likewise by union,
+    // difference and intersection instead of element-wise lookups.
+    RoaringReachablePairs OSPG_Roaring(Graph&& product, int bound_override = 0) {
+        // A bound for heavy/light partition of R
+        size_t bound = chooseOSPGBound(product, bound_override);
+
+        RoaringSet Ea;
+        RoaringSet Ec;  // Ec(Z, Z) for accepting Z
+        unordered_map<int, vector<int>> Eb_reverse; // fast lookup on the second column of Eb
+
+        unordered_map<int, RoaringSet> R_prev;
+        unordered_map<int, RoaringSet> delta_R_prev;
+        unordered_map<int, RoaringSet> Q;
+
+        START_LOCAL("OSPG_Roaring (Ea, Ec)");
+        Ea = RoaringSet(product.starting_vertices.begin(), product.starting_vertices.end());
+        Ec = RoaringSet(product.accepting_vertices.begin(), product.accepting_vertices.end());
+        END_LOCAL();
+
+        START_LOCAL("OSPG_Roaring (delta_R0, R0, Eb_reverse)");
+        // The degree condition is trivially satisfied
+        Ec.forEach([&](int z) {
+            delta_R_prev[z] = {z};
+        });
+        R_prev = delta_R_prev;
+
+        if (!delta_R_prev.empty()) {
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb_reverse[dest].push_back(src);
+            });
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG_Roaring (R)");
+        while (!delta_R_prev.empty()) {
+            unordered_map<int, RoaringSet> delta_R;
+
+            // delta R^i(X, Z)  = delta R^{i-1}(Y, Z) and Eb(X, b, Y) and not R^{i-1}(X, Z)
+            for (const auto& [y, zs] : delta_R_prev) {
+                auto search = Eb_reverse.find(y);
+                if (search == Eb_reverse.end()) {
+                    continue;
+                }
+                for (const auto& x: search->second) {
+                    RoaringSet& rx = R_prev[x];
+                    size_t degree = rx.size();
+                    if (degree >= bound) {
+                        continue;
+                    }
+                    RoaringSet fresh = zs - rx;
+                    if (fresh.empty()) {
+                        continue;
+                    }
+                    fresh.truncate(bound - degree);
+                    rx |= fresh;
+                    delta_R[x] |= fresh;
+                }
+            }
+            delta_R_prev = std::move(delta_R);
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG_Roaring (Ql)");
+        // Ql(X, Y) :- Rl(X, Y), Ea(X, X).
+        RoaringSet R_heavy;
+        for (auto& [x, ys]: R_prev) {
+            if (ys.size() >= bound) {
+                R_heavy.insert(x);
+            } else if (Ea.contains(x)) {
+                Q[x] = std::move(ys);
+            }
+        }
+        RECORD_STAT("OSPG heavy", R_heavy.size());
+        RECORD_STAT("OSPG light", R_prev.size() - R_heavy.size());
+        R_prev.clear();
+        END_LOCAL();
+
+        START_LOCAL("OSPG_Roaring (Eb)");
+        // delta T^0(Y, Y) :- R_heavy(Y), Ea(Y, Y)
+        unordered_map<int, RoaringSet> T_prev;
+        unordered_map<int, RoaringSet> delta_T_prev;
+        (R_heavy & Ea).forEach([&](int y) {
+            delta_T_prev[y] = {y};
+        });
+        T_prev = delta_T_prev;
+
+        // fast lookup on the first column of Eb
+        unordered_map<int, RoaringSet> Eb;
+        if (!delta_T_prev.empty()) {
+            product.forEachEdge([&](int src, LabelID, int dest) {
+                Eb[src].insert(dest);
+            });
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG_Roaring (T)");
+        while (!delta_T_prev.empty()) {
+            unordered_map<int, RoaringSet> delta_T;
+            // delta T^i(X, Y)  = delta T^{i-1}(X, Z) and Eb(Z, b, Y) and not T^{i-1}(X, Y)
+            for (const auto& [x, zs] : delta_T_prev) {
+                RoaringSet next;
+                zs.forEach([&](int z) {
+                    auto search = Eb.find(z);
+                    if (search != Eb.end()) {
+                        next |= search->second;
+                    }
+                });
+                RoaringSet& tx = T_prev[x];
+                next -= tx;
+                if (!next.empty()) {
+                    tx |= next;
+                    delta_T[x] = std::move(next);
+                }
+            }
+            delta_T_prev = std::move(delta_T);
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG_Roaring (Qh)");
+        // Qh(X, Y) :- T(X, Y), Ec(Y, Y)
+        for (const auto& [x, ys] : T_prev) {
+            RoaringSet qx = ys & Ec;
+            if (!qx.empty()) {
+                Q[x] = std::move(qx);
+            }
+        }
+        END_LOCAL();
+        return RoaringReachablePairs(Q);
+    }
+
+    // PG(Graph&&) over the strongly connected components of the product.
+    // R(X, Z) is the same for every X of a component, so it is computed once per
+    // component of the condensed DAG (successors first) and then T(X, Z) is read
+    // off for the starting vertices. Same answers as PG(Graph&&) and OSPG(Graph&&).
+    VectorReachablePairs PG_Condensed(Graph&& product) {
+        unordered_map<int, boost::container::flat_set<int>> T;
+        if (product.starting_vertices.empty() || product.accepting_vertices.empty()) {
+            return VectorReachablePairs(T);
+        }
+        shared_ptr<const CSRGraph> graph = product.denseView();
+        vector<bool> is_accepting(graph->numVertices(), false);
+        for (const auto& vertex : product.accepting_vertices) {
+            int dense = graph->denseId(vertex);
+            if (dense >= 0) {
+                is_accepting[dense] = true;
+            }
+        }
+
+        START_LOCAL("PG condensed (SCC)");
+        Condensation condensation(*graph);
+        END_LOCAL();
+
+        START_LOCAL("PG condensed (R)");
+        vector<vector<int>> R = condensation.reachableMarked(is_accepting);
+        END_LOCAL();
+
+        START_LOCAL("PG condensed (T)");
+        for (const auto& x : product.starting_vertices) {
+            int dense = graph->denseId(x);
+            if (dense < 0) {
+                // no edges: only the empty path from an accepting x
+                if (product.accepting_vertices.count(x)) {
+                    T[x] = {x};
+                }
+                continue;
+            }
+            const vector<int>& zs = R[condensation.componentOf(dense)];
+            if (zs.empty()) {
+                continue;
+            }
+            auto& tx = T[x];
+            for (int z : zs) {
+                tx.insert(graph->originalId(z));
+            }
+        }
+        END_LOCAL();
+        return VectorReachablePairs(T);
+    }
+
+    // On-the-fly evaluation: the product of graph and dfa is never built.
+    // The evaluators below traverse (DFA state, vertex) pairs through a
+    // ProductView and report (source, target) pairs of data vertices, where the
+    // source is paired with the DFA start state and the target with an
+    // accepting state. graph is sealed if it is not already.
+
+    // Graph::PG() (BFS from every starting product vertex) on the lazy product,
+    // streamed to emit(source, target) (see emitPair()). Neither the product
+    // nor the answer is stored: memory is one visited set over product
+    // vertices, the BFS queue and the data vertices already emitted for the
+    // current source (several accepting states may sit on one data vertex).
+    // A LIMIT stops the BFS of a source, or the whole stream, once reached.
+    template<typename Sink>
+    void PG_BFS_Stream(Graph& graph, NFA& dfa, Sink&& emit, const QueryLimit& limit = {}) {
+        graph.seal();
+        ProductView product(graph.getCSR(), graph.getReverseCSR(), dfa);
+        const CSRGraph& data = product.dataGraph();
+
+        START_LOCAL("BFS on-the-fly");
+        BitmapVisitedSet visited(size_t(product.numStates()) * data.numVertices());
+        EpochVisitedSet emitted(data.numVertices());
+        vector<ProductVertex> q;
+        size_t total = 0;
+        bool more = limit.total > 0;
+        for (int v = 0; more && v < data.numVertices(); ++v) {
+            ProductVertex start = product.encode(product.startState(), v);
+            visited.clear();
+            emitted.clear();
+            visited.insert(start);
+            q.assign(1, start);
+            size_t found = 0;
+
+            for (size_t head = 0; more && found < limit.per_source && head < q.size(); ++head) {
+                product.forEachSuccessor(q[head], [&](ProductVertex neighbor) {
+                    if (more && found < limit.per_source && visited.insert(neighbor)) {
+                        q.push_back(neighbor);
+                        int target = product.vertexOf(neighbor);
+                        if (product.isAccepting(neighbor) && emitted.insert(target)) {
+                            found++;
+                            more = emitPair(emit, data.originalId(v), data.originalId(target)) && ++total < limit.total;
+                        }
+                    }
+                });
+            }
+        }
+        END_LOCAL();
+    }
+
+    // Graph::PG() on the lazy product, collected from PG_BFS_Stream()
+    UnorderedReachablePairs PG_BFS_OnTheFly(Graph& graph, NFA& dfa) {
+        unordered_map<int, unordered_set<int>> result;
+        PG_BFS_Stream(graph, dfa, [&](int x, int y) {
+            result[x].insert(y);
+        });
+        return UnorderedReachablePairs(result);
+    }
+
+    // PG(Graph&&) on the lazy product: Ec are the accepting product vertices,
+    // and the join with Eb walks product predecessors instead of Eb_reverse
+    VectorReachablePairs PG_OnTheFly(Graph& graph, NFA& dfa) {
+        graph.seal();
+        ProductView product(graph.getCSR(), graph.getReverseCSR(), dfa);
+        const CSRGraph& data = product.dataGraph();
+
+        unordered_map<ProductVertex, boost::container::flat_set<ProductVertex>> R_prev;
+        unordered_map<ProductVertex, boost::container::flat_set<ProductVertex>> delta_R_prev;
+        unordered_map<int, boost::container::flat_set<int>> T;
+
+        START_LOCAL("PG semi-naive on-the-fly (delta_R0, R0)");
+        for (int q = 0; q < product.numStates(); ++q) {
+            // accepting states that cannot be entered only pair with themselves at the start
+            if (!product.isAcceptingState(q) || (q != product.startState() && !product.hasIncomingTransitions(q))) {
+                continue;
+            }
+            for (int v = 0; v < data.numVertices(); ++v) {
+                ProductVertex z = product.encode(q, v);
+                delta_R_prev[z] = {z};
+            }
+        }
+        R_prev = delta_R_prev;
+        END_LOCAL();
+
+        START_LOCAL("PG semi-naive on-the-fly (R)");
+        while (!delta_R_prev.empty()) {
+            unordered_map<ProductVertex, boost::container::flat_set<ProductVertex>> delta_R;
+
+            // delta R^i(X, Z)  = delta R^{i-1}(Y, Z) and Eb(X, b, Y) and not R^{i-1}(X, Z)
+            for (const auto& [y, zs] : delta_R_prev) {
+                product.forEachPredecessor(y, [&](ProductVertex x) {
+                    auto& rx = R_prev[x];
+                    for (const auto& z: zs) {
+                        if (rx.insert(z).second) {
+                            delta_R[x].insert(z);
+                        }
+                    }
+                });
+            }
+            delta_R_prev = std::move(delta_R);
+        }
+        END_LOCAL();
+
+        START_LOCAL("PG semi-naive on-the-fly (T)");
+        // T(X, Z) = Ea(X, a, X), R(X, Z)
+        for (const auto& [x, zs] : R_prev) {
+            if (product.stateOf(x) == product.startState()) {
+                auto& tx = T[data.originalId(product.vertexOf(x))];
+                for (const auto& z: zs) {
+                    tx.insert(data.originalId(product.vertexOf(z)));
+                }
+            }
+        }
+        END_LOCAL();
+        return VectorReachablePairs(T);
+    }
+
+    // OSPG(Graph&&) on the lazy product
+    UnorderedReachablePairs OSPG_OnTheFly(Graph& graph, NFA& dfa) {
+        graph.seal();
+        ProductView product(graph.getCSR(), graph.getReverseCSR(), dfa);
+        const CSRGraph& data = product.dataGraph();
+
+        // The product is not built, so its size is bounded by the data graph
+        int bound = chooseOSPGBound(data.numEdges(), 0, [&](size_t samples, size_t edge_budget) {
+            return sampleReach(product, samples, edge_budget);
+        });
+
+        unordered_map<ProductVertex, unordered_set<ProductVertex>> R_prev;
+        unordered_map<ProductVertex, unordered_set<ProductVertex>> delta_R_prev;
+        unordered_map<ProductVertex, int> degree;
+        unordered_map<int, unordered_set<int>> Q;
+
+        START_LOCAL("OSPG on-the-fly (delta_R0, R0)");
+        for (int q = 0; q < product.numStates(); ++q) {
+            if (!product.isAcceptingState(q) || (q != product.startState() && !product.hasIncomingTransitions(q))) {
+                continue;
+            }
+            for (int v = 0; v < data.numVertices(); ++v) {
+                ProductVertex z = product.encode(q, v);
+                delta_R_prev[z] = {z};
+                degree[z] = 1;
+            }
+        }
+        R_prev = delta_R_prev;
+        END_LOCAL();
+
+        START_LOCAL("OSPG on-the-fly (R)");
+        // Compute R(X, Y) satisfying degree(X) < bound
+        while (!delta_R_prev.empty()) {
+            unordered_map<ProductVertex, unordered_set<ProductVertex>> delta_R;
+            for (const auto& [y, zs] : delta_R_prev) {
+                product.forEachPredecessor(y, [&](ProductVertex x) {
+                    int& d = degree[x];
+                    auto& rx = R_prev[x];
+                    for (auto z_it = zs.begin(); d < bound && z_it != zs.end(); ++z_it) {
+                        if (rx.insert(*z_it).second) {
+                            delta_R[x].insert(*z_it);
+                            ++d;
+                        }
+                    }
+                });
+            }
+            delta_R_prev = std::move(delta_R);
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG on-the-fly (Ql)");
+        vector<ProductVertex> heavy;
+        for (const auto& [x, d] : degree) {
+            if (product.stateOf(x) != product.startState()) {
+                continue;
+            }
+            if (d >= bound) {
+                heavy.push_back(x);
+            } else {
+                auto& qx = Q[data.originalId(product.vertexOf(x))];
+                for (const auto& z : R_prev[x]) {
+                    qx.insert(data.originalId(product.vertexOf(z)));
+                }
+            }
+        }
+        END_LOCAL();
+
+        START_LOCAL("OSPG on-the-fly (Qh)");
+        // T(X, Y) by forward traversal from each heavy starting vertex, then T o Ec
+        BitmapVisitedSet visited;
+        if (!heavy.empty()) {
+            visited.resize(size_t(product.numStates()) * data.numVertices());
+        }
+        vector<ProductVertex> q;
+        for (ProductVertex x : heavy) {
+            auto& qx = Q[data.originalId(product.vertexOf(x))];
+            visited.clear();
+            visited.insert(x);
+            q.assign(1, x);
+            for (size_t head = 0; head < q.size(); ++head) {
+                ProductVertex z = q[head];
+                if (product.isAccepting(z)) {
+                    qx.insert(data.originalId(product.vertexOf(z)));
+                }
+                product.forEachSuccessor(z, [&](ProductVertex y) {
+                    if (visited.insert(y)) {
+                        q.push_back(y);
+                    }
+                });
+            }
+        }
+        END_LOCAL();
+        return UnorderedReachablePairs(Q);
+    }
+
+    // Arbitrary regular expressions: the linear datalog program of a regex
+    // (RegexProgram) evaluated over the per-label edge relations of a labelled
+    // data graph, sealed if it is not already. E_l(X, Y) are the edges of
+    // label l, read from the label runs of the CSR: the join of
+    // delta R_p(Y, Z) with E_l(X, Y) scans the in-edges of Y labelled l in the
+    // transposed CSR. Answers are in data vertex ids, with paths of zero or
+    // more edges as in PG_OnTheFly() for the DFA of the regex.
+    //
+    // Initialization, for every accepting q
+    // delta R_q^0(X, X) = V(X)
+    // R_q^0(X, X) = delta R_q^0(X, X)
+    //
+    // i = 0; repeat until delta R_q^i = \empty for all q
+    //  i += 1
+    //  for every rule R_q(X, Z) :- E_l(X, Y), R_p(Y, Z)
+    //   delta R_q^i(X, Z) = E_l(X, Y) and delta R_p^{i-1}(Y, Z) and not R_q^{i-1}(X, Z)
+    //  R_q^i(X, Z) = R_q^{i-1}(X, Z) or delta R_q^i(X, Z)
+    // T(X, Z) = R_start(X, Z)
+
+    typedef vector<unordered_map<int, boost::container::flat_set<int>>> RegexRelations;
+
+    // Semi-naive fixpoint of program, every row of every relation capped at
+    // bound values (no cap by default). R holds the base facts on entry.
+    inline void regexFixpoint(const CSRGraph& reverse, const RegexProgram& program, RegexRelations& R,
+                              size_t bound = numeric_limits<size_t>::max()) {
+        RegexRelations delta_prev = R;
+        vector<int> fresh;
+        auto pending = [](const RegexRelations& delta) {
+            return any_of(delta.begin(), delta.end(), [](const auto& relation) { return !relation.empty(); });
+        };
+        while (pending(delta_prev)) {
+            RegexRelations delta(program.numRelations());
+            for (int body = 0; body < program.numRelations(); ++body) {
+                for (const auto& [y, zs] : delta_prev[body]) {
+                    reverse.forEachLabelRun(y, [&](LabelID label, int begin, int end) {
+                        program.forEachHead(body, label, [&](int head) {
+                            for (int i = begin; i < end; ++i) {
+                                int x = reverse.targets[i];
+                                auto& rx = R[head][x];
+                                if (rx.size() >= bound) {
+                                    continue;
+                                }
+                                fresh.clear();
+                                set_difference(zs.begin(), zs.end(), rx.begin(), rx.end(), back_inserter(fresh));
+                                fresh.resize(min(fresh.size(), bound - rx.size()));
+                                if (!fresh.empty()) {
+                                    rx.insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                                    delta[head][x].insert(boost::container::ordered_unique_range, fresh.begin(), fresh.end());
+                                }
+                            }
+                        });
+                    });
+                }
+            }
+            delta_prev = std::move(delta);
+        }
+    }
+
+    // Base facts R_q(X, X) of program over the n data vertices
+    inline RegexRelations regexBaseFacts(const RegexProgram& program, int n) {
+        RegexRelations R(program.numRelations());
+        for (int q = 0; q < program.numRelations(); ++q) {
+            if (program.hasBaseRule(q)) {
+                for (int v = 0; v < n; ++v) {
+                    R[q][v] = {v};
+                }
+            }
+        }
+        return R;
+    }
+
+    // Semi-naive evaluation of program
+    VectorReachablePairs PG_Regex(Graph& graph, const RegexProgram& program) {
+        graph.seal();
+        const CSRGraph& data = graph.getCSR();
+
+        START_LOCAL("PG regex (delta_R0, R0)");
+        RegexRelations R = regexBaseFacts(program, data.numVertices());
+        END_LOCAL();
+
+        START_LOCAL("PG regex (R)");
+        regexFixpoint(graph.getReverseCSR(), program, R);
+        END_LOCAL();
+
+        START_LOCAL("PG regex (T)");
+        unordered_map<int, boost::container::flat_set<int>> T;
+        for (const auto& [x, zs] : R[program.answerRelation()]) {
+            auto& tx = T[data.originalId(x)];
+            for (int z : zs) {
+                tx.insert(data.originalId(z));
+            }
+        }
+        END_LOCAL();
+        return VectorReachablePairs(T);
+    }
+
+    // OSPG of program: the fixpoint keeps rows below the degree bound, X whose
+    // R_start row stays below it are light and answered from the row, and
+    // heavy X by a forward traversal of (relation, vertex) pairs along the
+    // rules. A positive bound_override is used as the bound; otherwise
+    // bestOSPGBound() on sampled traversals.
+    UnorderedReachablePairs OSPG_Regex(Graph& graph, const RegexProgram& program, int bound_override = 0) {
+        graph.seal();
+        const CSRGraph& data = graph.getCSR();
+        int n = data.numVertices();
+        // (relation, dense vertex) encoded as relation * n + vertex
+        auto successors = [&](ProductVertex p, auto&& f) {
+            int q = p / n;
+            data.forEachLabelRun(p % n, [&](LabelID label, int begin, int end) {
+                int body = program.bodyOf(q, label);
+                if (body == RegexProgram::NONE) {
+                    return;
+                }
+                for (int i = begin; i < end; ++i) {
+                    f(ProductVertex(body) * n + data.targets[i]);
+                }
+            });
+        };
+        auto is_accepting = [&](ProductVertex p) {
+            return program.hasBaseRule(p / n);
+        };
+
+        int bound = chooseOSPGBound(data.numEdges(), bound_override, [&](size_t samples, size_t edge_budget) {
+            vector<ProductVertex> starts(n);
+            for (int v = 0; v < n; ++v) {
+                starts[v] = ProductVertex(program.answerRelation()) * n + v;
+            }
+            ReachSample sample;
+            sample.starting = n;
+            sampleTraversals(pickSample(std::move(starts), samples, 1), size_t(program.numRelations()) * n,
+                             edge_budget, is_accepting, successors, sample);
+            return sample;
+        });
+
+        START_LOCAL("OSPG regex (delta_R0, R0)");
+        RegexRelations R = regexBaseFacts(program, n);
+        END_LOCAL();
+
+        START_LOCAL("OSPG regex (R)");
+        regexFixpoint(graph.getReverseCSR(), program, R, bound);
+        END_LOCAL();
+
+        START_LOCAL("OSPG regex (Ql)");
+        unordered_map<int, unordered_set<int>> Q;
+        vector<int> heavy;
+        for (const auto& [x, zs] : R[program.answerRelation()]) {
+            if (zs.size() >= size_t(bound)) {
+                heavy.push_back(x);
+                continue;
+            }
+            auto& qx = Q[data.originalId(x)];
+            for (int z : zs) {
+                qx.insert(data.originalId(z));
+            }
+        }
+        RECORD_STAT("OSPG heavy", heavy.size());
+        RECORD_STAT("OSPG light", R[program.answerRelation()].size() - heavy.size());
+        END_LOCAL();
+
+        START_LOCAL("OSPG regex (Qh)");
+        BitmapVisitedSet visited;
+        if (!heavy.empty()) {
+            visited.resize(size_t(program.numRelations()) * n);
+        }
+        vector<ProductVertex> q;
+        for (int x : heavy) {
+            auto& qx = Q[data.originalId(x)];
+            ProductVertex start = ProductVertex(program.answerRelation()) * n + x;
+            visited.clear();
+            visited.insert(start);
+            q.assign(1, start);
+            for (size_t head = 0; head < q.size(); ++head) {
+                ProductVertex z = q[head];
+                if (is_accepting(z)) {
+                    qx.insert(data.originalId(z % n));
+                }
+                successors(z, [&](ProductVertex y) {
+                    if (visited.insert(y)) {
+                        q.push_back(y);
+                    }
+                });
+            }
+        }
+        END_LOCAL();
+        return UnorderedReachablePairs(Q);
+    }
+
+    // Bound endpoints: answers of the on-the-fly evaluators above (paths of
+    // zero or more edges, as PG_OnTheFly()) restricted to the given source
+    // and/or target data vertices. Only the bound product vertices are seeded:
+    // sources are searched forward from (start state, source), targets
+    // backward from (accepting state, target) over the reverse DFA transitions
+    // and the transposed CSR. Ids that are not data vertices are ignored.
+
+    // Dense data ids of vertices, and a mask over them
+    inline vector<int> denseVertices(const CSRGraph& data, const vector<int>& vertices, vector<bool>& mask) {
+        vector<int> dense;
+        mask.assign(data.numVertices(), false);
+        for (int v : vertices) {
+            int d = data.denseId(v);
+            if (d >= 0 && !mask[d]) {
+                mask[d] = true;
+                dense.push_back(d);
+            }
+        }
+        return dense;
+    }
+
+    // Adds the pair of dense data vertices (source, target) to result
+    inline auto pairCollector(const CSRGraph& data, UnorderedReachablePairs& result) {
+        return [&data, &result](int source, int target) {
+            result.addPair(data.originalId(source), data.originalId(target));
+        };
+    }
+
+    // At most this many bound vertices are searched with SparseVisitedSet:
+    // their searches usually touch a small part of the product, which is then
+    // not allocated per query
+    static const size_t SPARSE_BOUND_VERTICES = 16;
+
+    // Forward search from each source; report(dense source, dense target)
+    // for targets in target_mask (if given)
+    template<typename Visited, typename Report>
+    void boundForwardWith(const ProductView& product, const vector<int>& sources, const vector<bool>* target_mask, Report&& report) {
+        const CSRGraph& data = product.dataGraph();
+        Visited visited(size_t(product.numStates()) * data.numVertices());
+        Visited emitted(data.numVertices());
+        vector<ProductVertex> q;
+        for (int v : sources) {
+            ProductVertex start = product.encode(product.startState(), v);
+            visited.clear();
+            emitted.clear();
+            visited.insert(start);
+            q.assign(1, start);
+            for (size_t head = 0; head < q.size(); ++head) {
+                ProductVertex z = q[head];
+                int target = product.vertexOf(z);
+                if (product.isAccepting(z) && (!target_mask || (*target_mask)[target]) && emitted.insert(target)) {
+                    report(v, target);
+                }
+                product.forEachSuccessor(z, [&](ProductVertex y) {
+                    if (visited.insert(y)) {
+                        q.push_back(y);
+                    }
+                });
+            }
+        }
+    }
+
+    template<typename Report>
+    void boundForward(const ProductView& product, const vector<int>& sources, const vector<bool>* target_mask, Report&& report) {
+        if (sources.size() <= SPARSE_BOUND_VERTICES) {
+            boundForwardWith<SparseVisitedSet>(product, sources, target_mask, report);
+        } else {
+            boundForwardWith<BitmapVisitedSet>(product, sources, target_mask, report);
+        }
+    }
+
+    // Backward search from all accepting product vertices of each target;
+    // report(dense source, dense target) for sources in source_mask (if given)
+    template<typename Visited, typename Report>
+    void boundBackwardWith(const ProductView& product, const vector<int>& targets, const vector<bool>* source_mask, Report&& report) {
+        const CSRGraph& data = product.dataGraph();
+        Visited visited(size_t(product.numStates()) * data.numVertices());
+        vector<ProductVertex> q;
+        for (int t : targets) {
+            visited.clear();
+            q.clear();
+            for (int state = 0; state < product.numStates(); ++state) {
+                if (product.isAcceptingState(state)) {
+                    ProductVertex seed = product.encode(state, t);
+                    visited.insert(seed);
+                    q.push_back(seed);
+                }
+            }
+            for (size_t head = 0; head < q.size(); ++head) {
+                ProductVertex z = q[head];
+                int source = product.vertexOf(z);
+                if (product.stateOf(z) == product.startState() && (!source_mask || (*source_mask)[source])) {
+                    report(source, t);
+                }
+                product.forEachPredecessor(z, [&](ProductVertex y) {
+                    if (visited.insert(y)) {
+                        q.push_back(y);
+                    }
+                });
+            }
+        }
+    }
+
+    template<typename Report>
+    void boundBackward(const ProductView& product, const vector<int>& targets, const vector<bool>* source_mask, Report&& report) {
+        if (targets.size() <= SPARSE_BOUND_VERTICES) {
+            boundBackwardWith<SparseVisitedSet>(product, targets, source_mask, report);
+        } else {
+            boundBackwardWith<BitmapVisitedSet>(product, targets, source_mask, report);
+        }
+    }
+
+    // Pairs (x, y) with x in sources
+    UnorderedReachablePairs PG_FromSources(Graph& graph, NFA& dfa, const vector<int>& sources) {
+        graph.seal();
+        ProductView product(graph.getCSR(), graph.getReverseCSR(), dfa);
+        vector<bool> source_mask;
+        vector<int> dense_sources = denseVertices(product.dataGraph(), sources, source_mask);
+        UnorderedReachablePairs result;
+        START_LOCAL("Source-bound on-the-fly");
+        boundForward(product, dense_sources, nullptr, pairCollector(product.dataGraph(), result));
+        END_LOCAL();
+        return result;
+    }
+
+    // Pairs (x, y) with y in targets
+    UnorderedReachablePairs PG_ToTargets(Graph& graph, NFA& dfa, const vector<int>& targets) {
+        graph.seal();
+        ProductView product(graph.getCSR(), graph.getReverseCSR(), dfa);
+        vector<bool> target_mask;
+        vector<int> dense_targets = denseVertices(product.dataGraph(), targets, target_mask);
+        UnorderedReachablePairs result;
+        START_LOCAL("Target-bound on-the-fly");
+        boundBackward(product, dense_targets, nullptr, pairCollector(product.dataGraph(), result));
+        END_LOCAL();
+        return result;
+    }
+
+    // Pairs (x, y) with x in sources and y in targets, searched from
+    // whichever side has fewer bound vertices
+    UnorderedReachablePairs PG_Between(Graph& graph, NFA& dfa, const vector<int>& sources, const vector<int>& targets) {
+        graph.seal();
+        ProductView product(graph.getCSR(), graph.getReverseCSR(), dfa);
+        vector<bool> source_mask, target_mask;
+        vector<int> dense_sources = denseVertices(product.dataGraph(), sources, source_mask);
+        vector<int> dense_targets = denseVertices(product.dataGraph(), targets, target_mask);
+        UnorderedReachablePairs result;
+        START_LOCAL("Source- and target-bound on-the-fly");
+        if (dense_sources.size() <= dense_targets.size()) {
+            boundForward(product, dense_sources, &target_mask, pairCollector(product.dataGraph(), result));
+        } else {
+            boundBackward(product, dense_targets, &source_mask, pairCollector(product.dataGraph(), result));
+        }
+        END_LOCAL();
+        return result;
+    }
+
+    // Query direction on the lazy product. Forward evaluation searches from
+    // (start state, v) for every data vertex v. Reversed evaluation runs the
+    // same search on the product of the transposed data graph and the DFA of
+    // the reversed regex (NFA::reverse()): it starts from the accepting side
+    // of the original query and reports every pair the other way round.
+
+    // All pairs of PG_OnTheFly(), searched forward from every data vertex
+    UnorderedReachablePairs PG_Forward(Graph& graph, NFA& dfa) {
+        graph.seal();
+        ProductView product(graph.getCSR(), graph.getReverseCSR(), dfa);
+        vector<int> sources(product.numDataVertices());
+        iota(sources.begin(), sources.end(), 0);
+        UnorderedReachablePairs result;
+        START_LOCAL("Forward on-the-fly");
+        boundForward(product, sources, nullptr, pairCollector(product.dataGraph(), result));
+        END_LOCAL();
+        return result;
+    }
+
+    // All pairs of PG_OnTheFly(), searched with the reversed regex over
+    // in-edges. reversed_dfa is the DFA of dfa.reverse().
+    UnorderedReachablePairs PG_Reversed(Graph& graph, NFA& reversed_dfa) {
+        graph.seal();
+        ProductView reversed(graph.getReverseCSR(), graph.getCSR(), reversed_dfa);
+        vector<int> targets(reversed.numDataVertices());
+        iota(targets.begin(), targets.end(), 0);
+        UnorderedReachablePairs result;
+        START_LOCAL("Reversed on-the-fly");
+        boundForward(reversed, targets, nullptr, [&](int target, int source) {
+            result.addPair(reversed.dataGraph().originalId(source), reversed.dataGraph().originalId(target));
+        });
+        END_LOCAL();
+        return result;
+    }
+
+    // Whether PG_Reversed() is expected to do less work than PG_Forward():
+    // compares the edges scanned by sampled searches from both sides
+    bool preferReversed(Graph& graph, NFA& dfa, NFA& reversed_dfa, size_t samples = 16) {
+        graph.seal();
+        size_t budget = max<size_t>(64, 2 * graph.getCSR().numEdges() / samples);
+        ReachSample forward = sampleReach(ProductView(graph.getCSR(), graph.getReverseCSR(), dfa), samples, budget);
+        ReachSample backward = sampleReach(ProductView(graph.getReverseCSR(), graph.getCSR(), reversed_dfa), samples, budget);
+        size_t forward_work = accumulate(forward.work.begin(), forward.work.end(), size_t(0));
+        size_t backward_work = accumulate(backward.work.begin(), backward.work.end(), size_t(0));
+        RECORD_STAT("Sampled work forward", forward_work);
+        RECORD_STAT("Sampled work reversed", backward_work);
+        return backward_work < forward_work;
+    }
+
+    // All pairs of PG_OnTheFly(), from whichever side preferReversed() picks
+    UnorderedReachablePairs PG_Directed(Graph& graph, NFA& dfa) {
+        NFA reversed_dfa = dfa.reverse().getDFA();
+        if (preferReversed(graph, dfa, reversed_dfa)) {
+            return PG_Reversed(graph, reversed_dfa);
+        }
+        return PG_Forward(graph, dfa);
+    }
+
+    // Single-pair checks "does u reach v" on the lazy product, by
+    // bidirectional BFS: forward from (start state, u) and backward from every
+    // (accepting state, v), expanding one level of the smaller frontier at a
+    // time until a product vertex is seen from both sides. Visited marks are
+    // kept across calls (epoch arrays for PairReachability), so a check costs
+    // only the vertices it touches. Paths of zero or more edges count, as in
+    // PG_Between(). graph is sealed if it is not already.
+    template<typename Visited>
+    class BasicPairReachability {
+    private:
+        ProductView product;
+        Visited forward_visited;
+        Visited backward_visited;
+        vector<ProductVertex> forward_frontier, backward_frontier, next;
+
+        static ProductView sealedProduct(Graph& graph, NFA& dfa) {
+            graph.seal();
+            return ProductView(graph.getCSR(), graph.getReverseCSR(), dfa);
+        }
+
+        // Expand one level of frontier; true once it touches the other side
+        template<typename Expand>
+        bool expandLevel(vector<ProductVertex>& frontier, Visited& visited, const Visited& other, Expand&& expand) {
+            next.clear();
+            bool met = false;
+            for (size_t i = 0; !met && i < frontier.size(); ++i) {
+                expand(frontier[i], [&](ProductVertex y) {
+                    if (!met && visited.insert(y)) {
+                        met = other.contains(y);
+                        next.push_back(y);
+                    }
+                });
+            }
+            frontier.swap(next);
+            return met;
+        }
+
+    public:
+        BasicPairReachability(Graph& graph, NFA& dfa)
+            : product(sealedProduct(graph, dfa)),
+              forward_visited(size_t(product.numStates()) * product.numDataVertices()),
+              backward_visited(size_t(product.numStates()) * product.numDataVertices()) {}
+
+        bool reaches(int source, int target) {
+            const CSRGraph& data = product.dataGraph();
+            int u = data.denseId(source), v = data.denseId(target);
+            if (u < 0 || v < 0) {
+                return false;
+            }
+            forward_visited.clear();
+            backward_visited.clear();
+            ProductVertex start = product.encode(product.startState(), u);
+            forward_visited.insert(start);
+            forward_frontier.assign(1, start);
+            backward_frontier.clear();
+            for (int state = 0; state < product.numStates(); ++state) {
+                if (product.isAcceptingState(state)) {
+                    ProductVertex seed = product.encode(state, v);
+                    if (seed == start) {
+                        return true;
+                    }
+                    backward_visited.insert(seed);
+                    backward_frontier.push_back(seed);
+                }
+            }
+
+            while (!forward_frontier.empty() && !backward_frontier.empty()) {
+                bool met;
+                if (forward_frontier.size() <= backward_frontier.size()) {
+                    met = expandLevel(forward_frontier, forward_visited, backward_visited, [&](ProductVertex p, auto&& f) {
+                        product.forEachSuccessor(p, f);
+                    });
+                } else {
+                    met = expandLevel(backward_frontier, backward_visited, forward_visited, [&](ProductVertex p, auto&& f) {
+                        product.forEachPredecessor(p, f);
+                    });
+                }
+                if (met) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    typedef BasicPairReachability<EpochVisitedSet> PairReachability;
+
+    // One-off PairReachability(graph, dfa).reaches(source, target); the marks
+    // are hashed instead of allocated over the whole product for one check
+    bool PG_PairExists(Graph& graph, NFA& dfa, int source, int target) {
+        START_LOCAL("Bidirectional pair check");
+        bool found = BasicPairReachability<SparseVisitedSet>(graph, dfa).reaches(source, target);
+        END_LOCAL();
+        return found;
+    }
+
     // semi-naive / output-sensitive transitive closure
     // delta T^0(X, Y) = E(X, Y)
     // T^0(X, Y) = delta T^0(X, Y)
@@ -910,7 +2604,7 @@ namespace rpqdb {
     //  delta T^i(X, Y)  = delta T^{i-1}(X, Z) and E(Z, Y) and not T^{i-1}(X, Y)
     //  T^i(X, Y) = T^{i-1}(X, Y) or delta T^i(X, Y)
     // return T^i
-    unordered_map<int, unordered_set<int>> ostc(Graph & graph) {
+    unordered_map<int, unordered_set<int>> ostc_SemiNaive(Graph & graph) {
         unordered_map<int, unordered_set<int>> E;
         unordered_map<int, unordered_set<int>> T;
 
@@ -931,13 +2625,9 @@ namespace rpqdb {
             }
         };
 
-        for (const auto& [src, edges] : graph.adjList) {
-            unordered_set<int> dst_set;
-            for (const Edge& e : edges) {
-                dst_set.insert(e.dest); 
-            }
-            E[src] = dst_set;
-        }
+        graph.forEachEdge([&](int src, LabelID, int dest) {
+            E[src].insert(dest);
+        });
         
         // delta T_0 and T_0
         delta_prev = E;
@@ -967,4 +2657,232 @@ namespace rpqdb {
 
         return T;
     }
+
+    // Transitive closure T(X, Y) of graph through BitsetClosure (bitset rows
+    // over the condensed DAG). Same result as ostc_SemiNaive(): one entry per
+    // vertex with an outgoing edge.
+    unordered_map<int, unordered_set<int>> ostc(Graph & graph) {
+        unordered_map<int, unordered_set<int>> T;
+        shared_ptr<const CSRGraph> csr = graph.denseView();
+
+        START_LOCAL("TC bitset (closure)");
+        BitsetClosure closure(*csr);
+        END_LOCAL();
+
+        START_LOCAL("TC bitset (T)");
+        for (int x = 0; x < csr->numVertices(); ++x) {
+            if (csr->outDegree(x) == 0) {
+                continue;
+            }
+            auto& tx = T[csr->originalId(x)];
+            closure.forEachReachable(x, [&](int y) {
+                tx.insert(csr->originalId(y));
+            });
+        }
+        END_LOCAL();
+        return T;
+    }
+
+    // Query planning: choose an evaluator for a product graph from cheap
+    // statistics. All planned evaluators give the answers of PG(Graph&&).
+
+    enum class Engine { BFS, BFS_Backward, BFS_BitParallel, Condensed, SemiNaive, OSPG, OSPG_OrderedVector, OSPG_Roaring };
+
+    inline string engineName(Engine engine) {
+        switch (engine) {
+            case Engine::BFS: return "BFS";
+            case Engine::BFS_Backward: return "BFS backward";
+            case Engine::BFS_BitParallel: return "BFS bit-parallel";
+            case Engine::Condensed: return "condensed (SCC)";
+            case Engine::SemiNaive: return "semi-naive PG";
+            case Engine::OSPG: return "OSPG (hash sets)";
+            case Engine::OSPG_OrderedVector: return "OSPG (sorted vectors)";
+            default: return "OSPG (compressed bitmaps)";
+        }
+    }
+
+    struct GraphStatistics {
+        size_t vertices = 0;
+        size_t edges = 0;
+        size_t starting = 0;
+        size_t accepting = 0;
+        size_t max_out_degree = 0;
+        double degree_skew = 0;     // max / average out-degree
+        size_t components = 0;      // strongly connected components
+        ReachSample sample;         // reach of sampled starting vertices
+        double average_reach = 0;
+        double average_work = 0;    // edges scanned per sampled BFS
+        ReachSample backward_sample;    // backward BFS from sampled accepting vertices
+        double average_backward_work = 0;
+        OutputEstimate output;
+
+        static GraphStatistics collect(Graph& product) {
+            GraphStatistics stats;
+            shared_ptr<const CSRGraph> graph = product.denseView();
+            stats.vertices = graph->numVertices();
+            stats.edges = graph->numEdges();
+            stats.starting = product.starting_vertices.size();
+            stats.accepting = product.accepting_vertices.size();
+            for (int v = 0; v < graph->numVertices(); ++v) {
+                stats.max_out_degree = max<size_t>(stats.max_out_degree, graph->outDegree(v));
+            }
+            if (stats.edges > 0) {
+                stats.degree_skew = stats.max_out_degree * double(stats.vertices) / stats.edges;
+            }
+            stats.components = Condensation(*graph).numComponents();
+
+            const size_t samples = 16;
+            stats.sample = sampleReach(product, samples, max<size_t>(64, 2 * stats.edges / samples));
+            for (size_t i = 0; i < stats.sample.reached.size(); ++i) {
+                stats.average_reach += stats.sample.reached[i];
+                stats.average_work += stats.sample.work[i];
+            }
+            if (!stats.sample.reached.empty()) {
+                stats.average_reach /= stats.sample.reached.size();
+                stats.average_work /= stats.sample.reached.size();
+            }
+            stats.backward_sample = sampleReachBackward(product, samples, max<size_t>(64, 2 * stats.edges / samples));
+            if (!stats.backward_sample.work.empty()) {
+                stats.average_backward_work = accumulate(stats.backward_sample.work.begin(), stats.backward_sample.work.end(), 0.0)
+                                              / stats.backward_sample.work.size();
+            }
+            stats.output = estimateOutputSize(stats.sample);
+            return stats;
+        }
+    };
+
+    struct QueryPlan {
+        Engine engine = Engine::BFS;
+        int ospg_bound = 0;
+        GraphStatistics stats;
+        vector<pair<Engine, double>> costs;     // estimated edge visits per engine
+        vector<string> reasons;
+
+        string explain() const {
+            stringstream ss;
+            ss << "Plan: " << engineName(engine) << "\n";
+            ss << "  graph: " << stats.vertices << " vertices, " << stats.edges << " edges, "
+               << stats.starting << " starting, " << stats.accepting << " accepting\n";
+            ss << "  out-degree: max " << stats.max_out_degree << ", skew (max/avg) " << stats.degree_skew << "\n";
+            ss << "  strongly connected components: " << stats.components << "\n";
+            ss << "  sampled " << stats.sample.reached.size() << " starting vertices: average reach "
+               << stats.average_reach << ", average BFS work " << stats.average_work
+               << " edges (" << stats.output.truncated << " cut short)\n";
+            ss << "  sampled " << stats.backward_sample.work.size() << " accepting vertices: average backward BFS work "
+               << stats.average_backward_work << " edges\n";
+            ss << "  estimated output: " << stats.output.pairs << " pairs, 95% interval ["
+               << stats.output.low << ", " << stats.output.high << "]\n";
+            ss << "  estimated cost (edge visits):";
+            for (const auto& [candidate, cost] : costs) {
+                ss << " " << engineName(candidate) << " " << cost << ";";
+            }
+            ss << "\n";
+            for (const auto& reason : reasons) {
+                ss << "  " << reason << "\n";
+            }
+            return ss.str();
+        }
+    };
+
+    // Cost model, in edge visits:
+    //  - BFS: one traversal per starting vertex; bit-parallel BFS shares one
+    //    traversal between 256 sources but pays for the bitmask words
+    //  - backward BFS: one traversal over in-edges per accepting vertex
+    //  - semi-naive PG: every reachable accepting vertex crosses every edge once
+    //  - condensed: the same, but only once per component, plus the SCC pass
+    //  - OSPG: estimateOSPGCost() at its best bound
+    // The cheapest engine wins. OSPG rows are stored as sorted vectors when
+    // they are small, as compressed bitmaps when they are large, and as hash
+    // sets otherwise.
+    QueryPlan planQuery(Graph& product) {
+        START_LOCAL("Plan query");
+        QueryPlan plan;
+        GraphStatistics& stats = plan.stats;
+        stats = GraphStatistics::collect(product);
+
+        double starting = stats.starting, edges = stats.edges;
+        double bfs = starting * stats.average_work;
+        double bfs_backward = double(stats.accepting) * stats.average_backward_work;
+        double bit_parallel = std::ceil(starting / 256) * (stats.vertices + edges) * 4;
+        double semi_naive = edges * stats.average_reach;
+        double condensed = stats.vertices + edges + semi_naive * stats.components / max<size_t>(1, stats.vertices);
+        plan.ospg_bound = bestOSPGBound(stats.sample, stats.edges);
+        double ospg = estimateOSPGCost(stats.sample, stats.edges, plan.ospg_bound);
+        plan.costs = {{Engine::BFS, bfs}, {Engine::BFS_Backward, bfs_backward}, {Engine::BFS_BitParallel, bit_parallel}, {Engine::SemiNaive, semi_naive},
+                      {Engine::Condensed, condensed}, {Engine::OSPG, ospg}};
+
+        auto best = min_element(plan.costs.begin(), plan.costs.end(), [](const auto& a, const auto& b) {
+            return a.second < b.second;
+        });
+        plan.engine = best->first;
+        plan.reasons.push_back("chosen: lowest estimated cost");
+        if (stats.starting == 0 || stats.accepting == 0) {
+            plan.engine = Engine::BFS;
+            plan.reasons.push_back("no starting or accepting vertices: empty answer");
+        } else if (plan.engine == Engine::OSPG) {
+            plan.reasons.push_back("OSPG degree bound " + to_string(plan.ospg_bound));
+            double row = 0;
+            for (size_t r : stats.sample.reached) {
+                row += min<size_t>(r, plan.ospg_bound);
+            }
+            row /= max<size_t>(1, stats.sample.reached.size());
+            if (row < 64) {
+                plan.engine = Engine::OSPG_OrderedVector;
+                plan.reasons.push_back("rows average " + to_string(row) + " values (< 64): sorted vectors");
+            } else if (row >= 4096) {
+                plan.engine = Engine::OSPG_Roaring;
+                plan.reasons.push_back("rows average " + to_string(row) + " values (>= 4096): compressed bitmaps");
+            } else {
+                plan.reasons.push_back("rows average " + to_string(row) + " values: hash sets");
+            }
+        }
+        END_LOCAL();
+        return plan;
+    }
+
+    using PlanResult = variant<UnorderedReachablePairs, VectorReachablePairs, RoaringReachablePairs>;
+
+    // Runs the planned engine on product
+    PlanResult evaluate(Graph& product, const QueryPlan& plan) {
+        // BFS reports a start only through a path of one or more edges
+        auto add_reflexive = [&](UnorderedReachablePairs pairs) {
+            for (int x : product.starting_vertices) {
+                if (product.accepting_vertices.count(x)) {
+                    pairs.addPair(x, x);
+                }
+            }
+            return pairs;
+        };
+        switch (plan.engine) {
+            case Engine::BFS:
+                return add_reflexive(product.PG());
+            case Engine::BFS_Backward:
+                return add_reflexive(product.PG_Backward());
+            case Engine::BFS_BitParallel:
+                return add_reflexive(product.PG_BitParallel());
+            case Engine::Condensed:
+                return PG_Condensed(std::move(product));
+            case Engine::SemiNaive:
+                return PG(std::move(product));
+            case Engine::OSPG:
+                return OSPG(std::move(product), plan.ospg_bound);
+            case Engine::OSPG_OrderedVector:
+                return OSPG_OrderedVector(std::move(product), plan.ospg_bound);
+            default:
+                return OSPG_Roaring(std::move(product), plan.ospg_bound);
+        }
+    }
+
+    // Plans and runs; the plan is written to explain, if given
+    PlanResult evaluate(Graph& product, ostream* explain = nullptr) {
+        QueryPlan plan = planQuery(product);
+        if (explain) {
+            *explain << plan.explain();
+        }
+        return evaluate(product, plan);
+    }
+
+    inline size_t resultSize(const PlanResult& result) {
+        return visit([](const auto& pairs) { return pairs.size(); }, result);
+    }
 }
\ No newline at end of file
@@ -73,6 +73,653 @@ bool test_productGraph(Graph & graph){
     return true;
 }
 
+bool test_sealedGraph(Graph & graph){
+    cout << "Started test sealed graph" << endl;
+    Graph sealed = graph;
+    sealed.seal();
+    ASSERT_TRUE(sealed.isSealed());
+    ASSERT_EQ(sealed.getEdges(), graph.getEdges());
+    ASSERT_EQ(sealed.getVertexCount(), graph.getVertexCount());
+    ASSERT_TRUE(sealed.getAdjacencyList().empty());
+
+    auto data_nfa = sealed.constructDFA(1, {11});
+    ASSERT_TRUE(data_nfa.accepts("helloworld"));
+    ASSERT_FALSE(data_nfa.accepts("hello"));
+
+    NFA dfa1 = post2nfa(re2post("l*o")).getDFA();
+    NFA dfa2 = post2nfa(re2post("l*o")).getDFA();
+    Graph product = graph.product(dfa1);
+    Graph sealed_product = sealed.product(dfa2);
+    sealed_product.seal();
+    ASSERT_EQ(sealed_product.PG().size(), product.PG().size());
+    ASSERT_EQ(PG(std::move(sealed_product)).size(), PG(std::move(product)).size());
+    ASSERT_EQ(OSPG(std::move(sealed_product)).size(), OSPG(std::move(product)).size());
+    return true;
+}
+
+bool test_snapshot(Graph & graph){
+    cout << "Started test snapshot" << endl;
+    Graph original = graph;
+    original.starting_vertices = {1, 4};
+    original.accepting_vertices = {7, 11};
+    original.saveSnapshot("test_graph.snap");
+
+    Graph mapped;
+    mapped.loadSnapshot("test_graph.snap");
+    ASSERT_TRUE(mapped.isSealed());
+    ASSERT_EQ(mapped.getEdges(), original.getEdges());
+    ASSERT_EQ(mapped.getVertexCount(), original.getVertexCount());
+    ASSERT_TRUE(mapped.starting_vertices == original.starting_vertices);
+    ASSERT_TRUE(mapped.accepting_vertices == original.accepting_vertices);
+    ASSERT_TRUE(mapped.getCSR().storage != original.getCSR().storage);
+
+    auto data_nfa = mapped.constructDFA(1, {11});
+    ASSERT_TRUE(data_nfa.accepts("helloworld"));
+    ASSERT_EQ(mapped.PG().size(), original.PG().size());
+    std::remove("test_graph.snap");
+    return true;
+}
+
+// Whether loading filename is rejected with runtime_error
+bool snapshotRejected(const string& filename){
+    try {
+        Graph loaded;
+        loaded.loadSnapshot(filename);
+    } catch (const runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+bool test_corruptSnapshot(Graph & graph){
+    cout << "Started test corrupt snapshot" << endl;
+    Graph original = graph;
+    original.saveSnapshot("test_graph.snap");
+    ifstream in("test_graph.snap", ios::binary);
+    string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+
+    // sections: header, vertex ids, offsets, targets, labels, ...
+    size_t n = original.getCSR().numVertices(), m = original.getCSR().numEdges();
+    auto padded = [](size_t b) { return (b + 7) / 8 * 8; };
+    size_t offsets = padded(sizeof(SnapshotHeader)) + padded(n * sizeof(int));
+    size_t targets = offsets + padded((n + 1) * sizeof(int));
+    size_t labels = targets + padded(m * sizeof(int));
+    auto corrupted = [&](size_t pos, int value) {
+        string copy = bytes;
+        memcpy(&copy[pos], &value, sizeof(int));
+        ofstream out("test_corrupt.snap", ios::binary);
+        out << copy;
+        out.close();
+        return snapshotRejected("test_corrupt.snap");
+    };
+    ASSERT_TRUE(corrupted(targets, int(n)));
+    ASSERT_TRUE(corrupted(targets, -1));
+    ASSERT_TRUE(corrupted(labels, 1 << 20));
+    ASSERT_TRUE(corrupted(offsets + sizeof(int), int(m) + 1));
+    ASSERT_TRUE(corrupted(offsets, 1));
+
+    ofstream truncated("test_corrupt.snap", ios::binary);
+    truncated << bytes.substr(0, targets + 4);
+    truncated.close();
+    ASSERT_TRUE(snapshotRejected("test_corrupt.snap"));
+    ASSERT_FALSE(snapshotRejected("test_graph.snap"));
+    std::remove("test_corrupt.snap");
+    std::remove("test_graph.snap");
+    return true;
+}
+
+bool test_parallelLoader(const string& filename, bool labelled){
+    cout << "Started test parallel loader on " << filename << endl;
+    Graph serial;
+    if (labelled) {
+        serial.buildLabelledGraphFromFile(filename, " ");
+    } else {
+        serial.buildFromFile(filename, " ");
+    }
+    for (int threads : {1, 3, 8}) {
+        Graph parallel;
+        parallel.buildFromFileParallel(filename, " ", labelled, threads);
+        ASSERT_TRUE(parallel.isSealed());
+        ASSERT_EQ(parallel.getEdges(), serial.getEdges());
+        ASSERT_EQ(parallel.getVertexCount(), serial.getVertexCount());
+        ASSERT_TRUE(parallel.starting_vertices == serial.starting_vertices);
+        ASSERT_TRUE(parallel.accepting_vertices == serial.accepting_vertices);
+
+        set<tuple<int, LabelID, int>> expected, actual;
+        serial.forEachEdge([&](int src, LabelID label, int dest) { expected.insert({src, label, dest}); });
+        parallel.forEachEdge([&](int src, LabelID label, int dest) { actual.insert({src, label, dest}); });
+        ASSERT_TRUE(expected == actual);
+    }
+    return true;
+}
+
+bool test_onTheFlyProduct(const string& filename, const string& pattern){
+    cout << "Started test on-the-fly product for " << pattern << endl;
+    Graph graph;
+    graph.buildFromFile(filename, " ");
+    NFA dfa = post2nfa(re2post(pattern)).getDFA();
+    Graph product = graph.product(dfa);
+
+    size_t bfs = product.PG().size();
+    size_t seminaive = PG(std::move(product)).size();
+    size_t ospg = OSPG(std::move(product)).size();
+    ASSERT_EQ(product.PG_Condensed().size(), bfs);
+    ASSERT_EQ(PG_Condensed(std::move(product)).size(), seminaive);
+    ASSERT_EQ(OSPG_Roaring(std::move(product)).size(), ospg);
+    ASSERT_EQ(PG_Parallel(std::move(product), 1).size(), seminaive);
+    ASSERT_EQ(PG_Parallel(std::move(product), 4).size(), seminaive);
+    ASSERT_EQ(OSPG_Parallel(std::move(product), 1).size(), ospg);
+    ASSERT_EQ(OSPG_Parallel(std::move(product), 4).size(), ospg);
+    ASSERT_EQ(OSPG_Parallel(std::move(product), 2, 1).size(), ospg);
+    ASSERT_EQ(PG_Count(std::move(product)), seminaive);
+    ASSERT_EQ(OSPG_Count(std::move(product)), ospg);
+    ASSERT_EQ(OSPG_Count(std::move(product), 1), ospg);
+    ASSERT_EQ(OSPG_Count(std::move(product), 2), ospg);
+    ASSERT_TRUE(PG_Exists(std::move(product)) == (seminaive > 0));
+    for (int bound : {1, 2, 5}) {
+        ASSERT_EQ(OSPG(std::move(product), bound).size(), ospg);
+        ASSERT_EQ(OSPG_OrderedVector(std::move(product), bound).size(), ospg);
+        ASSERT_EQ(OSPG_Roaring(std::move(product), bound).size(), ospg);
+        ASSERT_EQ(EventProfiler::get_stat("OSPG bound").back(), bound);
+    }
+    ASSERT_EQ(PG_BFS_OnTheFly(graph, dfa).size(), bfs);
+    ASSERT_EQ(PG_OnTheFly(graph, dfa).size(), seminaive);
+    ASSERT_EQ(OSPG_OnTheFly(graph, dfa).size(), ospg);
+    return true;
+}
+
+bool test_onTheFlyProducts(){
+    string mySrcDir = MY_SRC_DIR;
+    ASSERT_TRUE(test_onTheFlyProduct(mySrcDir + "/resources/disjoint_cycles_10.txt", "b*c"));
+    ASSERT_TRUE(test_onTheFlyProduct(mySrcDir + "/resources/graph_tc.txt", "a*b"));
+    ASSERT_TRUE(test_onTheFlyProduct(mySrcDir + "/resources/path_100.txt", "bb*"));
+    // b* accepts the empty path of 3, which has no edge in the product
+    ASSERT_TRUE(test_onTheFlyProduct(mySrcDir + "/resources/isolated_vertex.txt", "b*"));
+    return true;
+}
+
+bool test_skewedOSPG(){
+    cout << "Started test OSPG on a skewed graph" << endl;
+    // hubs 0..3 with b-edges to most vertices, a b-path through 4..999 and
+    // c-loops on every 7th vertex: both heavy and light starting vertices
+    ofstream skewed("test_skewed.txt");
+    for (int hub = 0; hub < 4; ++hub) {
+        for (int v = 4; v < 400; ++v) {
+            skewed << hub << " b " << v << "\n";
+        }
+    }
+    for (int v = 4; v < 1000; ++v) {
+        if (v + 1 < 1000) {
+            skewed << v << " b " << v + 1 << "\n";
+        }
+        if (v % 7 == 0) {
+            skewed << v << " c " << v << "\n";
+        }
+    }
+    skewed.close();
+    Graph graph;
+    graph.buildFromFile("test_skewed.txt", " ");
+    std::remove("test_skewed.txt");
+    NFA dfa = post2nfa(re2post("b*c")).getDFA();
+    Graph product = graph.product(dfa);
+
+    size_t expected = PG(std::move(product)).size();
+    ASSERT_EQ(product.PG().size(), expected);
+    ASSERT_EQ(OSPG(std::move(product)).size(), expected);
+    ASSERT_TRUE(EventProfiler::get_stat("OSPG heavy").back() > 0);
+    ASSERT_TRUE(EventProfiler::get_stat("OSPG light").back() > 0);
+    ASSERT_EQ(OSPG_Parallel(std::move(product), 1).size(), expected);
+    ASSERT_EQ(OSPG_Parallel(std::move(product), 4).size(), expected);
+    ASSERT_EQ(OSPG_Count(std::move(product)), expected);
+    return true;
+}
+
+bool test_condensation(){
+    // 1 <-> 2 -> 3 -> 4 -> 3, 5 alone
+    CSRGraph csr = CSRGraph::fromArrays({1, 2, 3, 4, 5}, {0, 1, 3, 4, 5, 5}, {1, 0, 2, 3, 2}, {0, 0, 0, 0, 0});
+    Condensation condensation(csr);
+    ASSERT_EQ(condensation.numComponents(), 3);
+    ASSERT_EQ(condensation.componentOf(0), condensation.componentOf(1));
+    ASSERT_EQ(condensation.componentOf(2), condensation.componentOf(3));
+    ASSERT_EQ(condensation.componentSize(condensation.componentOf(2)), 2);
+    // successors come first
+    ASSERT_TRUE(condensation.componentOf(2) < condensation.componentOf(0));
+
+    vector<vector<int>> reach = condensation.reachableMarked({false, false, false, true, true});
+    ASSERT_TRUE(reach[condensation.componentOf(0)] == vector<int>{3});
+    ASSERT_TRUE(reach[condensation.componentOf(2)] == vector<int>{3});
+    ASSERT_TRUE(reach[condensation.componentOf(4)] == vector<int>{4});
+    return true;
+}
+
+bool test_transitiveClosure(){
+    string mySrcDir = MY_SRC_DIR;
+    for (const char* file : {"graph_tc.txt", "disjoint_cycles_10.txt", "path_100.txt"}) {
+        cout << "Started test transitive closure on " << file << endl;
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        ASSERT_TRUE(ostc(graph) == ostc_SemiNaive(graph));
+    }
+    return true;
+}
+
+bool test_roaringSet(){
+    // sparse, dense and consecutive chunks, plus values across chunk borders
+    set<int> a_values, b_values;
+    for (int v = 0; v < 200000; v += 7) a_values.insert(v);
+    for (int v = 65000; v < 140000; ++v) b_values.insert(v);
+    for (int v = 300000; v < 300100; v += 3) b_values.insert(v);
+    RoaringSet a(a_values.begin(), a_values.end());
+    RoaringSet b(b_values.begin(), b_values.end());
+    ASSERT_EQ(a.size(), a_values.size());
+    ASSERT_TRUE(vector<int>(a.begin(), a.end()) == vector<int>(a_values.begin(), a_values.end()));
+
+    set<int> expected_or, expected_and, expected_minus;
+    set_union(a_values.begin(), a_values.end(), b_values.begin(), b_values.end(), inserter(expected_or, expected_or.end()));
+    set_intersection(a_values.begin(), a_values.end(), b_values.begin(), b_values.end(), inserter(expected_and, expected_and.end()));
+    set_difference(a_values.begin(), a_values.end(), b_values.begin(), b_values.end(), inserter(expected_minus, expected_minus.end()));
+    for (bool runs : {false, true}) {
+        if (runs) {
+            b.runOptimize();
+            ASSERT_EQ(b.size(), b_values.size());
+            ASSERT_TRUE(b.contains(100000));
+            ASSERT_FALSE(b.contains(300001));
+        }
+        ASSERT_TRUE((a | b) == RoaringSet(expected_or.begin(), expected_or.end()));
+        ASSERT_TRUE((a & b) == RoaringSet(expected_and.begin(), expected_and.end()));
+        ASSERT_TRUE((a - b) == RoaringSet(expected_minus.begin(), expected_minus.end()));
+        ASSERT_TRUE(vector<int>(b.begin(), b.end()) == vector<int>(b_values.begin(), b_values.end()));
+    }
+
+    RoaringSet c = a;
+    c.truncate(10000);
+    ASSERT_EQ(c.size(), 10000);
+    ASSERT_TRUE(c.contains(7 * 9999));
+    ASSERT_FALSE(c.contains(7 * 10000));
+    ASSERT_TRUE(c.insert(7 * 10000));
+    ASSERT_FALSE(c.insert(7 * 10000));
+    return true;
+}
+
+bool test_outputEstimate(){
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_100.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_100.txt", "bb*"}}) {
+        cout << "Started test output estimate on " << file << endl;
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        Graph product = graph.product(dfa);
+        double exact = PG(std::move(product)).size();
+
+        // sampling every starting vertex with enough budget is exact
+        OutputEstimate full = estimateOutputSize(product, product.starting_vertices.size(), product.getEdges() + 1);
+        ASSERT_EQ(full.pairs, exact);
+        ASSERT_EQ(full.low, exact);
+        ASSERT_EQ(full.high, exact);
+
+        OutputEstimate sampled = estimateOutputSize(product, 8);
+        ASSERT_TRUE(sampled.low <= sampled.pairs && sampled.pairs <= sampled.high);
+        ASSERT_EQ(sampled.samples, min<size_t>(8, product.starting_vertices.size()));
+
+        OutputEstimate lazy = estimateOutputSize(graph, dfa, graph.getVertexCount(), graph.getEdges() * 4 + 1);
+        ASSERT_EQ(lazy.pairs, double(PG_OnTheFly(graph, dfa).size()));
+    }
+    return true;
+}
+
+bool test_existence(){
+    // 1 is starting and accepting and reaches itself through a cycle only;
+    // adding 3 -> 2 -> 1 makes (3, 1) a pair
+    for (bool other_start : {false, true}) {
+        ofstream labelled("test_exists.txt");
+        labelled << "1 a 1\n1 c 1\n1 b 2\n2 b 1\n";
+        if (other_start) {
+            labelled << "3 a 3\n3 b 2\n";
+        }
+        labelled.close();
+        Graph product;
+        product.buildLabelledGraphFromFile("test_exists.txt", " ");
+        std::remove("test_exists.txt");
+        ASSERT_EQ(product.PG().size(), other_start ? 1 : 0);
+        ASSERT_TRUE(product.PG_Exists() == other_start);
+        ASSERT_EQ(product.PG_Count(), other_start ? 1 : 0);
+        ASSERT_TRUE(PG_Exists(std::move(product)));
+        ASSERT_EQ(PG_Count(std::move(product)), PG(std::move(product)).size());
+    }
+    return true;
+}
+
+bool test_planner(){
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_10.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_100.txt", "bb*"}, {"isolated_vertex.txt", "b*"}}) {
+        cout << "Started test planner on " << file << endl;
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        Graph product = graph.product(dfa);
+        size_t expected = PG(std::move(product)).size();
+
+        QueryPlan plan = planQuery(product);
+        ASSERT_TRUE(plan.explain().find("Plan: " + engineName(plan.engine)) == 0);
+        ASSERT_EQ(plan.stats.vertices, size_t(product.getVertexCount()));
+        ASSERT_EQ(resultSize(evaluate(product, plan)), expected);
+        ASSERT_EQ(resultSize(evaluate(product)), expected);
+        stringstream explained;
+        ASSERT_EQ(resultSize(evaluate(product, &explained)), expected);
+        ASSERT_TRUE(explained.str() == plan.explain());
+        for (Engine engine : {Engine::BFS, Engine::BFS_Backward, Engine::BFS_BitParallel, Engine::Condensed, Engine::SemiNaive,
+                              Engine::OSPG, Engine::OSPG_OrderedVector, Engine::OSPG_Roaring}) {
+            plan.engine = engine;
+            ASSERT_EQ(resultSize(evaluate(product, plan)), expected);
+        }
+    }
+    return true;
+}
+
+// Compare two results of the BFS evaluators pair by pair
+bool samePairs(const UnorderedReachablePairs& expected, const UnorderedReachablePairs& actual){
+    ASSERT_EQ(actual.size(), expected.size());
+    bool same = true;
+    expected.forEachPair([&](int x, int y) { same = same && actual.contains(x, y); });
+    ASSERT_TRUE(same);
+    return true;
+}
+
+bool test_bfsVariants(){
+    cout << "Started test BFS variants" << endl;
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_10.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_1000.txt", "bb*"}}) {
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        Graph product = graph.product(dfa);
+        UnorderedReachablePairs expected = product.PG();
+
+        ASSERT_TRUE(samePairs(expected, product.PG_BitParallel<1>()));
+        ASSERT_TRUE(samePairs(expected, product.PG_BitParallel()));
+        ASSERT_TRUE(samePairs(expected, product.PG_Parallel(3)));
+        ASSERT_TRUE(samePairs(expected, product.PG_DirectionOptimizing()));
+        // switch to bottom-up at once and never back; each bottom-up level
+        // scans every vertex, too slow for the long path
+        bool force_bottom_up = product.getVertexCount() <= 1000;
+        if (force_bottom_up) {
+            ASSERT_TRUE(samePairs(expected, product.PG_DirectionOptimizing(1e9, 1e9)));
+            ASSERT_TRUE(EventProfiler::get_stat("BFS bottom-up levels").back() > 0);
+        }
+        ASSERT_TRUE(samePairs(expected, product.PG_Condensed()));
+        ASSERT_TRUE(samePairs(expected, product.PG_Backward()));
+        ASSERT_EQ(product.PG_Count(), expected.size());
+        ASSERT_EQ(product.PG_Count<1>(), expected.size());
+        ASSERT_TRUE(product.PG_Exists() == (expected.size() > 0));
+        product.seal();
+        ASSERT_TRUE(samePairs(expected, product.PG_Backward()));
+        ASSERT_TRUE(samePairs(expected, product.PG_BitParallel()));
+        ASSERT_TRUE(samePairs(expected, product.PG_Parallel(4)));
+        if (force_bottom_up) {
+            ASSERT_TRUE(samePairs(expected, product.PG_DirectionOptimizing(1e9, 1e9)));
+            ASSERT_TRUE(EventProfiler::get_stat("BFS bottom-up levels").back() > 0);
+        }
+    }
+    return true;
+}
+
+bool test_streaming(){
+    cout << "Started test streaming results" << endl;
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_10.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_1000.txt", "bb*"}}) {
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        Graph product = graph.product(dfa);
+
+        // every pair is emitted exactly once
+        UnorderedReachablePairs bfs, lazy, ospg;
+        size_t bfs_emitted = 0, lazy_emitted = 0, ospg_emitted = 0;
+        product.PG_Stream([&](int x, int y) { bfs.addPair(x, y); bfs_emitted++; });
+        PG_BFS_Stream(graph, dfa, [&](int x, int y) { lazy.addPair(x, y); lazy_emitted++; });
+        OSPG_Stream(std::move(product), [&](int x, int y) { ospg.addPair(x, y); ospg_emitted++; }, 2);
+        ASSERT_TRUE(samePairs(product.PG(), bfs));
+        ASSERT_EQ(bfs_emitted, bfs.size());
+        ASSERT_TRUE(samePairs(PG_BFS_OnTheFly(graph, dfa), lazy));
+        ASSERT_EQ(lazy_emitted, lazy.size());
+        ASSERT_TRUE(samePairs(OSPG(std::move(product)), ospg));
+        ASSERT_EQ(ospg_emitted, ospg.size());
+
+        // a sink returning false stops the evaluation
+        for (size_t limit : {1, 3}) {
+            size_t seen = 0;
+            product.PG_Stream([&](int, int) { return ++seen < limit; });
+            ASSERT_EQ(seen, min(limit, bfs.size()));
+            seen = 0;
+            PG_BFS_Stream(graph, dfa, [&](int, int) { return ++seen < limit; });
+            ASSERT_EQ(seen, min(limit, lazy.size()));
+            seen = 0;
+            OSPG_Stream(std::move(product), [&](int, int) { return ++seen < limit; });
+            ASSERT_EQ(seen, min(limit, ospg.size()));
+        }
+    }
+    return true;
+}
+
+// limited holds pairs of full only, as many as limit allows
+template<typename Full, typename Limited>
+bool withinLimit(const Full& full, const Limited& limited, const QueryLimit& limit){
+    map<int, size_t> per_source;
+    full.forEachPair([&](int x, int) { per_source[x]++; });
+    size_t expected = 0;
+    for (const auto& [x, n] : per_source) {
+        expected += min(n, limit.per_source);
+    }
+    ASSERT_EQ(limited.size(), min(expected, limit.total));
+    bool contained = true;
+    map<int, size_t> kept;
+    limited.forEachPair([&](int x, int y) {
+        contained = contained && full.contains(x, y) && ++kept[x] <= limit.per_source;
+    });
+    ASSERT_TRUE(contained);
+    return true;
+}
+
+bool test_limits(){
+    cout << "Started test LIMIT" << endl;
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_10.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_100.txt", "bb*"}}) {
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        Graph product = graph.product(dfa);
+        UnorderedReachablePairs bfs = product.PG();
+        UnorderedReachablePairs lazy = PG_BFS_OnTheFly(graph, dfa);
+        VectorReachablePairs seminaive = PG(std::move(product));
+
+        QueryLimit first5, two_each, one_each_of7, none;
+        first5.total = 5;
+        two_each.per_source = 2;
+        one_each_of7.total = 7;
+        one_each_of7.per_source = 1;
+        none.per_source = 0;
+        for (const QueryLimit& limit : {first5, two_each, one_each_of7, none, QueryLimit()}) {
+            ASSERT_TRUE(withinLimit(bfs, product.PG(limit), limit));
+            UnorderedReachablePairs streamed;
+            PG_BFS_Stream(graph, dfa, [&](int x, int y) { streamed.addPair(x, y); }, limit);
+            ASSERT_TRUE(withinLimit(lazy, streamed, limit));
+            ASSERT_TRUE(withinLimit(seminaive, PG(std::move(product), limit), limit));
+            for (int bound : {1, 3}) {
+                ASSERT_TRUE(withinLimit(seminaive, OSPG(std::move(product), limit, bound), limit));
+            }
+        }
+    }
+    return true;
+}
+
+bool test_boundEndpoints(){
+    cout << "Started test bound endpoints" << endl;
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_10.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_100.txt", "bb*"}, {"graph_tc.txt", "a*"}}) {
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        VectorReachablePairs all = PG_OnTheFly(graph, dfa);
+        const CSRGraph& data = graph.getCSR();
+
+        // every third vertex as sources, every second as targets, plus an unknown id
+        vector<int> sources{-7}, targets{-7};
+        for (int v = 0; v < data.numVertices(); ++v) {
+            if (v % 3 == 0) {
+                sources.push_back(data.originalId(v));
+            }
+            if (v % 2 == 0) {
+                targets.push_back(data.originalId(v));
+            }
+        }
+        set<int> source_set(sources.begin(), sources.end()), target_set(targets.begin(), targets.end());
+        UnorderedReachablePairs from, to, between, between_few;
+        all.forEachPair([&](int x, int y) {
+            if (source_set.count(x)) {
+                from.addPair(x, y);
+            }
+            if (target_set.count(y)) {
+                to.addPair(x, y);
+            }
+            if (source_set.count(x) && target_set.count(y)) {
+                between.addPair(x, y);
+            }
+            if (source_set.count(x) && y == targets[1]) {
+                between_few.addPair(x, y);
+            }
+        });
+        ASSERT_TRUE(samePairs(from, PG_FromSources(graph, dfa, sources)));
+        ASSERT_TRUE(samePairs(to, PG_ToTargets(graph, dfa, targets)));
+        // searched forward from the sources, then backward from one target
+        ASSERT_TRUE(samePairs(between, PG_Between(graph, dfa, sources, targets)));
+        ASSERT_TRUE(samePairs(between_few, PG_Between(graph, dfa, sources, {targets[1]})));
+    }
+    return true;
+}
+
+bool test_pairReachability(){
+    cout << "Started test single-pair reachability" << endl;
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_10.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_100.txt", "bb*"}, {"graph_tc.txt", "a*"}}) {
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        VectorReachablePairs all = PG_OnTheFly(graph, dfa);
+        const CSRGraph& data = graph.getCSR();
+
+        PairReachability checker(graph, dfa);
+        size_t found = 0;
+        bool agree = true;
+        for (int u = 0; u < data.numVertices(); ++u) {
+            for (int v = 0; v < data.numVertices(); ++v) {
+                int x = data.originalId(u), y = data.originalId(v);
+                bool reaches = checker.reaches(x, y);
+                agree = agree && reaches == all.contains(x, y);
+                found += reaches;
+            }
+        }
+        ASSERT_TRUE(agree);
+        ASSERT_EQ(found, all.size());
+        ASSERT_FALSE(checker.reaches(-7, data.originalId(0)));
+        for (int v : {0, 1, data.numVertices() - 1}) {
+            int x = data.originalId(0), y = data.originalId(v);
+            ASSERT_TRUE(PG_PairExists(graph, dfa, x, y) == all.contains(x, y));
+        }
+    }
+    return true;
+}
+
+bool test_reversedQuery(){
+    cout << "Started test reversed query" << endl;
+    string mySrcDir = MY_SRC_DIR;
+    for (const auto& [file, pattern] : vector<pair<string, string>>{{"disjoint_cycles_10.txt", "b*c"}, {"graph_tc.txt", "a*b"}, {"path_100.txt", "bb*"}, {"graph_tc.txt", "ab*"}}) {
+        Graph graph;
+        graph.buildFromFile(mySrcDir + "/resources/" + file, " ");
+        NFA dfa = post2nfa(re2post(pattern)).getDFA();
+        NFA reversed_query = dfa.reverse().getDFA();
+        VectorReachablePairs expected = PG_OnTheFly(graph, dfa);
+        UnorderedReachablePairs forward = PG_Forward(graph, dfa);
+        UnorderedReachablePairs backward = PG_Reversed(graph, reversed_query);
+        UnorderedReachablePairs directed = PG_Directed(graph, dfa);
+        ASSERT_EQ(forward.size(), expected.size());
+        ASSERT_TRUE(samePairs(forward, backward));
+        ASSERT_TRUE(samePairs(forward, directed));
+    }
+    return true;
+}
+
+bool test_regexProgram(const string& filename, const string& pattern){
+    cout << "Started test regex program for " << pattern << endl;
+    Graph graph;
+    graph.buildFromFile(filename, " ");
+    NFA dfa = post2nfa(re2post(pattern)).getDFA();
+    RegexProgram program = RegexProgram::fromRegex(pattern);
+    VectorReachablePairs expected = PG_OnTheFly(graph, dfa);
+
+    VectorReachablePairs seminaive = PG_Regex(graph, program);
+    ASSERT_EQ(seminaive.size(), expected.size());
+    bool same = true;
+    expected.forEachPair([&](int x, int y) { same = same && seminaive.contains(x, y); });
+    ASSERT_TRUE(same);
+    for (int bound : {0, 1, 2, 5}) {
+        UnorderedReachablePairs ospg = OSPG_Regex(graph, program, bound);
+        ASSERT_EQ(ospg.size(), expected.size());
+        ASSERT_TRUE(bound == 0 || EventProfiler::get_stat("OSPG bound").back() == bound);
+        expected.forEachPair([&](int x, int y) { same = same && ospg.contains(x, y); });
+        ASSERT_TRUE(same);
+    }
+    return true;
+}
+
+bool test_regexPrograms(){
+    // ab*c compiles to the program hardcoded in PG(Graph&&)
+    RegexProgram abc = RegexProgram::fromRegex("ab*c");
+    ASSERT_EQ(abc.numRelations(), 3);
+    ASSERT_EQ(abc.getRules().size(), 3);
+    ASSERT_EQ(abc.toString(), "T(X, Z) :- R0(X, Z).\n"
+                              "R2(X, X) :- V(X).\n"
+                              "R0(X, Z) :- E_a(X, Y), R1(Y, Z).\n"
+                              "R1(X, Z) :- E_b(X, Y), R1(Y, Z).\n"
+                              "R1(X, Z) :- E_c(X, Y), R2(Y, Z).\n");
+    // equivalent DFA states share a relation
+    ASSERT_EQ(RegexProgram::fromRegex("(k|f)+w").numRelations(), 3);
+
+    // random graph with labels k(nows), f(ollows) and w(orksAt)
+    ofstream labelled("test_regex.txt");
+    unsigned state = 7;
+    for (int e = 0; e < 160; ++e) {
+        state = state * 1103515245 + 12345;
+        int from = (state >> 8) % 50;
+        state = state * 1103515245 + 12345;
+        int to = (state >> 8) % 50;
+        labelled << from << " " << "kfw"[(state >> 4) % 3] << " " << to << "\n";
+    }
+    labelled.close();
+    for (const char* pattern : {"(k|f)+w", "k*f?w", "(kf)*", "w", "k(f|w)*k", "f*"}) {
+        ASSERT_TRUE(test_regexProgram("test_regex.txt", pattern));
+    }
+    std::remove("test_regex.txt");
+
+    string mySrcDir = MY_SRC_DIR;
+    ASSERT_TRUE(test_regexProgram(mySrcDir + "/resources/graph_tc.txt", "a*b"));
+    ASSERT_TRUE(test_regexProgram(mySrcDir + "/resources/path_100.txt", "bb*"));
+    return true;
+}
+
+bool test_parallelLoaders(){
+    string mySrcDir = MY_SRC_DIR;
+    ofstream labelled("test_labelled.txt");
+    labelled << "1 a 1\n1 b 2\n2 b 3\n3 c 3\n2 c 2\n4 a 4\n4 b 1";
+    labelled.close();
+
+    ASSERT_TRUE(test_parallelLoader(mySrcDir + "/resources/graph_tc.txt", false));
+    ASSERT_TRUE(test_parallelLoader(mySrcDir + "/resources/disjoint_cycles_1000.txt", false));
+    ASSERT_TRUE(test_parallelLoader("test_labelled.txt", true));
+    std::remove("test_labelled.txt");
+    return true;
+}
+
 int main() {
     Graph graph;
     // path relative to the binary (here in the local build)
@@ -83,6 +730,9 @@ int main() {
     // graph.print();
     fixture_test(graph, test_graphDFA1);
     fixture_test(graph, test_graphDFA2);
+    fixture_test(graph, test_sealedGraph);
+    fixture_test(graph, test_snapshot);
+    fixture_test(graph, test_corruptSnapshot);
 
     Graph graph2;
     graph2.buildFromFile(mySrcDir + "/resources/graph2.txt", " ");
@@ -95,5 +745,22 @@ int main() {
     graph3.buildFromFile(mySrcDir + "/resources/graph_tc.txt", " ");
     cout << "Successfully loaded graph_tc!" << endl;
     fixture_test(graph3, test_productGraph);
+
+    RUN_TEST(test_parallelLoaders);
+    RUN_TEST(test_onTheFlyProducts);
+    RUN_TEST(test_skewedOSPG);
+    RUN_TEST(test_bfsVariants);
+    RUN_TEST(test_streaming);
+    RUN_TEST(test_limits);
+    RUN_TEST(test_boundEndpoints);
+    RUN_TEST(test_pairReachability);
+    RUN_TEST(test_reversedQuery);
+    RUN_TEST(test_regexPrograms);
+    RUN_TEST(test_condensation);
+    RUN_TEST(test_transitiveClosure);
+    RUN_TEST(test_roaringSet);
+    RUN_TEST(test_outputEstimate);
+    RUN_TEST(test_existence);
+    RUN_TEST(test_planner);
     return 0;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "rpqdb/NFA.hpp"
+#include "rpqdb/DFATable.hpp"
 #include "tests.hpp"
 
 using namespace rpqdb;
@@ -27,6 +28,72 @@ bool testAccept() {
 	ASSERT_FALSE(recognizes("a(b|c)*d", "abbbb"));
 	ASSERT_TRUE(recognizes("a(b|c)*d", "abbcbcbd"));
 	ASSERT_TRUE(recognizes("a(b|c)*d", "abbbbbd"));
+	ASSERT_FALSE(recognizes("ab+c", "ac"));
+	ASSERT_TRUE(recognizes("ab+c", "abc"));
+	ASSERT_TRUE(recognizes("ab+c", "abbbc"));
+	ASSERT_TRUE(recognizes("(b|c)+d", "cbd"));
+	ASSERT_TRUE(recognizes("ab?c", "ac"));
+	ASSERT_TRUE(recognizes("ab?c", "abc"));
+	ASSERT_FALSE(recognizes("ab?c", "abbc"));
+	return true;
+}
+
+bool recognizesReversed(const string& l, const string& word) {
+	NFA reversed = post2nfa(re2post(l)).reverse();
+	return reversed.accepts(word);
+}
+
+bool testReverse() {
+	ASSERT_TRUE(recognizesReversed("ab*c", "cba"));
+	ASSERT_TRUE(recognizesReversed("ab*c", "cbbba"));
+	ASSERT_TRUE(recognizesReversed("ab*c", "ca"));
+	ASSERT_FALSE(recognizesReversed("ab*c", "abc"));
+	ASSERT_FALSE(recognizesReversed("ab*c", "cb"));
+	ASSERT_TRUE(recognizesReversed("b*", ""));
+	ASSERT_TRUE(recognizesReversed("a(b|c)*d", "dcbba"));
+	ASSERT_FALSE(recognizesReversed("a(b|c)*d", "abcd"));
+
+	// the DFA of the reverse accepts the same words
+	NFA reversed_dfa = post2nfa(re2post("ab*c")).reverse().getDFA();
+	ASSERT_TRUE(reversed_dfa.accepts("cbba"));
+	ASSERT_TRUE(reversed_dfa.accepts("ca"));
+	ASSERT_FALSE(reversed_dfa.accepts("abbc"));
+	return true;
+}
+
+bool testLabelDictionary() {
+	LabelDictionary& labels = LabelDictionary::global();
+	ASSERT_EQ(labels.find(""), LabelDictionary::EPSILON);
+	LabelID b = internLabel("b");
+	ASSERT_EQ(internLabel("b"), b);
+	ASSERT_EQ(labelName(b), "b");
+	ASSERT_EQ(labels.find("not-a-label"), LabelDictionary::NONE);
+
+	NFA dfa = post2nfa(re2post("b*")).getDFA();
+	ASSERT_EQ(dfa.start_state->transitions.size(), 1);
+	ASSERT_EQ(dfa.start_state->transitions[0].label, b);
+	return true;
+}
+
+bool testDFATable() {
+	NFA dfa = post2nfa(re2post("ab*c")).getDFA();
+	DFATable table(dfa);
+	LabelID a = internLabel("a"), b = internLabel("b"), c = internLabel("c");
+	int s0 = table.startState();
+	int s1 = table.next(s0, a);
+	ASSERT_TRUE(s1 != DFATable::NONE);
+	ASSERT_EQ(table.next(s0, b), DFATable::NONE);
+	ASSERT_FALSE(table.isAccepting(s1));
+	int s2 = table.next(s1, b);
+	ASSERT_EQ(table.next(s2, b), s2);
+	int s3 = table.next(s2, c);
+	ASSERT_TRUE(table.isAccepting(s3));
+	ASSERT_EQ(table.next(s1, c), s3);
+	ASSERT_EQ(table.next(s3, internLabel("unseen")), DFATable::NONE);
+
+	set<int> previous;
+	table.forEachPrevious(s3, c, [&](int p) { previous.insert(p); });
+	ASSERT_TRUE(previous == set<int>({s1, s2}));
 	return true;
 }
 
@@ -48,6 +115,9 @@ void toDFATest() {
 
 int main(int argc, char **argv) {
 	RUN_TEST(testAccept);
+	RUN_TEST(testReverse);
+	RUN_TEST(testLabelDictionary);
+	RUN_TEST(testDFATable);
 	toDFATest();
 	return 0;
 }
\ No newline at end of file
@@ -26,6 +26,8 @@ class OSPGTest : public QueryGraphClass {
         OSPG_OrderedVector(std::move(product));
         OSPG(std::move(product));    
         OSPG_OrderedSet(std::move(product));
+        OSPG_Roaring(std::move(product));
+        OSPG_Parallel(std::move(product));
 
         EventProfiler::export_to_file(profile_name);
         return;
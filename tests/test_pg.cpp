@@ -35,6 +35,8 @@ class PGTest : public QueryGraphClass {
         // START_LOCAL("Semi-naive PG total");
         PG(std::move(product));
         // END_LOCAL();
+
+        PG_Parallel(std::move(product));
     
         // START_LOCAL("OSPG total");
         OSPG(std::move(product));